@@ -0,0 +1,218 @@
+#pragma once
+
+// Host only: times the hot paths with std::chrono, so it is compiled on Linux builds and is empty elsewhere.
+
+#if defined(__linux__)
+
+#include <vislib.hpp>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+#include "imuFilter.hpp"
+#include "mpc.hpp"
+
+namespace vislib::benchmark {
+
+// Durations of the timed operations in seconds. Operations too short for the clock are timed in batches,
+// min and max are then the fastest and slowest batch mean.
+struct BenchmarkResult {
+    size_t operations = 0;
+    double totalSeconds = 0;
+    double minSeconds = 0;
+    double maxSeconds = 0;
+
+    inline double meanSeconds() const noexcept {
+        return operations > 0 ? totalSeconds / static_cast<double>(operations) : 0;
+    }
+
+    inline double perSecond() const noexcept {
+        return totalSeconds > 0 ? static_cast<double>(operations) / totalSeconds : 0;
+    }
+};
+
+class Stopwatch {
+protected:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+
+    inline void restart() noexcept {
+        start = std::chrono::steady_clock::now();
+    }
+
+    inline double seconds() const noexcept {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+class BenchmarkRecorder {
+protected:
+    BenchmarkResult result{};
+
+public:
+
+    // duration of a batch of count operations
+    void record(double seconds, size_t count = 1) noexcept {
+        if(count == 0) return;
+
+        const double each = seconds / static_cast<double>(count);
+
+        if(result.operations == 0 || each < result.minSeconds) result.minSeconds = each;
+        if(result.operations == 0 || result.maxSeconds < each) result.maxSeconds = each;
+
+        result.operations += count;
+        result.totalSeconds += seconds;
+    }
+
+    inline const BenchmarkResult& get() const noexcept {
+        return result;
+    }
+};
+
+inline void printBenchmark(const char* name, const BenchmarkResult& result) noexcept {
+    printf("%s: %zu ops, %.0f ops/s, mean %.3f us, min %.3f us, max %.3f us\n",
+        name,
+        result.operations,
+        result.perSecond(),
+        result.meanSeconds() * 1e6,
+        result.minSeconds * 1e6,
+        result.maxSeconds * 1e6);
+}
+
+// Keeps a benchmarked result alive so the optimizer can't drop the work producing it.
+template <typename T> inline void keep(const T& value) noexcept {
+    volatile T sink = value;
+    (void)sink;
+}
+
+struct FilterBenchmarkConfig {
+    double sampleRate = 1000;
+    double cutoff = 80;
+    double notchCenter = 150;
+    double notchQ = 5;
+    size_t samples = 1000000;
+    size_t batch = 1000;
+};
+
+// Three axis gyro samples per second through a low-pass and notch VectorFilterChain decimated by Factor,
+// the chain a FilteredAngularSpeedGetter runs. The input is motor vibration over a slow rotation, precomputed
+// so only the filter is timed.
+template <typename T = double, size_t Factor = 1> [[nodiscard]] core::Result<BenchmarkResult> benchmarkImuFilter(const FilterBenchmarkConfig& config = {}) noexcept {
+    if(config.samples == 0 || config.batch == 0) return core::Error(core::ErrorCode::invalidArgument, "The benchmark needs samples and a positive batch size");
+
+    core::Result<gyro::Biquad<T>> lowPass = gyro::Biquad<T>::lowPass(T(config.sampleRate), T(config.cutoff));
+    if(lowPass) return lowPass.error();
+
+    core::Result<gyro::Biquad<T>> notch = gyro::Biquad<T>::notch(T(config.sampleRate), T(config.notchCenter), T(config.notchQ));
+    if(notch) return notch.error();
+
+    gyro::VectorFilterChain<T, 2, Factor, 3> chain;
+
+    core::Error err = chain.setStage(0, lowPass());
+    if(err) return err;
+
+    err = chain.setStage(1, notch());
+    if(err) return err;
+
+    constexpr size_t inputs = 64;
+    core::Vector<T> input[inputs];
+
+    for(size_t i = 0; i < inputs; i++) {
+        const double t = static_cast<double>(i) / config.sampleRate;
+
+        input[i] = core::Vector<T>(3);
+        for(size_t axis = 0; axis < 3; axis++) {
+            input[i][axis] = T(10 * static_cast<double>(axis) + 30 * sin(2 * 3.14159265358979323846 * config.notchCenter * t + static_cast<double>(axis)));
+        }
+    }
+
+    BenchmarkRecorder recorder;
+    Stopwatch watch;
+    size_t outputs = 0;
+
+    for(size_t done = 0; done < config.samples;) {
+        const size_t count = core::minF(config.batch, config.samples - done);
+
+        watch.restart();
+
+        for(size_t i = 0; i < count; i++) {
+            core::Result<bool> ready = chain.process(input[(done + i) % inputs]);
+            if(ready) return ready.error();
+
+            if(ready()) outputs++;
+        }
+
+        recorder.record(watch.seconds(), count);
+        done += count;
+    }
+
+    keep(outputs);
+
+    core::Result<core::Vector<T>> last = chain.get();
+    if(!last) keep(last()[0]);
+
+    return recorder.get();
+}
+
+struct MpcBenchmarkConfig {
+    size_t ticks = 5000;
+    size_t warmupTicks = 100;
+    size_t referencePeriod = 50;
+    double referenceScale = 1;
+};
+
+// Time of every VelocityMpc::solve() tick, the max is the worst case a control loop has to budget for.
+// The reference cycles through in-range and out-of-range velocities every referencePeriod ticks, so the
+// wheel limits are both idle and active, and the current velocity is the model's own prediction.
+template <size_t Horizon, size_t MaxMotors> [[nodiscard]] core::Result<BenchmarkResult> benchmarkVelocityMpc(
+    const platform::PlatformMotorConfig& motors,
+    const platform::VelocityMpcConfig& mpcConfig = {},
+    const MpcBenchmarkConfig& config = {}) noexcept {
+
+    if(config.ticks == 0 || config.referencePeriod == 0) return core::Error(core::ErrorCode::invalidArgument, "The benchmark needs ticks and a positive reference period");
+
+    platform::VelocityMpc<Horizon, MaxMotors> mpc;
+
+    core::Error err = mpc.configure(motors, mpcConfig);
+    if(err) return err;
+
+    const double s = config.referenceScale;
+    const platform::VelocityCommand references[] = {
+        {0.5 * s, 0, 0},
+        {3 * s, 0, 5 * s},
+        {-s, s, -2 * s},
+        {0, 0, 0},
+        {0, 4 * s, 0}
+    };
+    constexpr size_t referenceCount = sizeof(references) / sizeof(references[0]);
+
+    BenchmarkRecorder recorder;
+    Stopwatch watch;
+    platform::VelocityCommand current{};
+
+    for(size_t tick = 0; tick < config.warmupTicks + config.ticks; tick++) {
+        const platform::VelocityCommand& reference = references[(tick / config.referencePeriod) % referenceCount];
+
+        watch.restart();
+
+        core::Result<platform::VelocityCommand> command = mpc.solve(current, reference);
+
+        const double seconds = watch.seconds();
+
+        if(command) return command.error();
+
+        if(tick >= config.warmupTicks) recorder.record(seconds);
+
+        current = mpc.predictNext(current);
+    }
+
+    keep(mpc.getLastCommand().vx);
+
+    return recorder.get();
+}
+
+} // namespace vislib::benchmark
+
+#endif
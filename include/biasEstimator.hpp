@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vislib.hpp>
+
+#include "gyro.hpp"
+
+namespace vislib::gyro {
+
+template <typename T> struct ZeroVelocityDetectorConfig {
+    T accelerationVarianceThreshold = T(0.0004);
+    T angularSpeedThreshold = T(3);
+    T statisticsWeight = T(0.05);
+    T biasLearningRate = T(0.005);
+    size_t minStationarySamples = 100;
+};
+
+// Tracks gyro bias while the robot stands still. A sample is considered stationary when motors are
+// commanded to zero, the accelerometer magnitude variance is low and the bias-corrected angular speed is small.
+// All statistics are exponential moving averages, so every update is O(1) with no sample history.
+template <typename T> class ZeroVelocityBiasEstimator {
+protected:
+    ZeroVelocityDetectorConfig<T> config{};
+    YPR<T> bias{T(), T(), T()};
+    T accelerationMean{};
+    T accelerationVariance{};
+    size_t stationarySamples = 0;
+    bool hasStatistics = false;
+
+public:
+    ZeroVelocityBiasEstimator() = default;
+
+    ZeroVelocityBiasEstimator(const ZeroVelocityDetectorConfig<T>& config, const YPR<T>& initialBias = YPR<T>{T(), T(), T()}) noexcept(core::numberNoexcept<T>())
+    : config(config), bias(initialBias) {}
+
+    [[nodiscard]] core::Result<bool> update(const Acceleration<T>& acceleration, const AngularSpeed<T>& speed, bool isCommandedStill) noexcept(core::numberNoexcept<T>()) {
+
+        if(acceleration.Size() < 3 || speed.Size() < 3) return core::Error(core::ErrorCode::invalidArgument, "Bias estimator requires three axis acceleration and angular speed");
+
+        const T magnitude = sqrt(acceleration[0] * acceleration[0] + acceleration[1] * acceleration[1] + acceleration[2] * acceleration[2]);
+
+        if(!hasStatistics) {
+            accelerationMean = magnitude;
+            accelerationVariance = T();
+            hasStatistics = true;
+        }
+
+        const T diff = magnitude - accelerationMean;
+        accelerationMean += config.statisticsWeight * diff;
+        accelerationVariance = (T(1) - config.statisticsWeight) * (accelerationVariance + config.statisticsWeight * diff * diff);
+
+        const T yawRate = speed[0] - bias.yaw;
+        const T pitchRate = speed[1] - bias.pitch;
+        const T rollRate = speed[2] - bias.roll;
+
+        const bool isStill = isCommandedStill
+            && accelerationVariance < config.accelerationVarianceThreshold
+            && core::absF(yawRate) < config.angularSpeedThreshold
+            && core::absF(pitchRate) < config.angularSpeedThreshold
+            && core::absF(rollRate) < config.angularSpeedThreshold;
+
+        if(!isStill) {
+            stationarySamples = 0;
+            return false;
+        }
+
+        if(stationarySamples < config.minStationarySamples) {
+            stationarySamples++;
+            return false;
+        }
+
+        bias.yaw += config.biasLearningRate * yawRate;
+        bias.pitch += config.biasLearningRate * pitchRate;
+        bias.roll += config.biasLearningRate * rollRate;
+
+        return true;
+    }
+
+    template <typename TimeType, typename WT> void applyTo(YPRCalculator<T, TimeType, WT>& calculator) const noexcept(core::numberNoexcept<T>()) {
+        calculator.setYawBias(bias.yaw);
+        calculator.setPitchBias(bias.pitch);
+        calculator.setRollBias(bias.roll);
+    }
+
+    inline constexpr bool isStationary() const noexcept {
+        return stationarySamples >= config.minStationarySamples;
+    }
+
+    inline YPR<T> getBias() const noexcept(core::numberNoexcept<T>()) {
+        return bias;
+    }
+
+    inline void setBias(const YPR<T>& bias) noexcept(core::numberNoexcept<T>()) {
+        this->bias = bias;
+    }
+
+    inline void reset() noexcept(core::numberNoexcept<T>()) {
+        stationarySamples = 0;
+        hasStatistics = false;
+    }
+};
+
+} // namespace vislib::gyro
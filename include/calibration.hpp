@@ -0,0 +1,141 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <stdio.h>
+#endif
+
+#include "gyro.hpp"
+#include "checksum.hpp"
+
+namespace vislib::gyro {
+
+// blob layout: magic(2) | version(1) | scalar size(1) | offset ypr | bias ypr | crc16(2)
+
+constexpr uint16_t calibrationBlobMagic = 0x4356;
+constexpr uint8_t calibrationBlobVersion = 1;
+constexpr size_t calibrationBlobHeaderSize = 4;
+
+template <typename T> constexpr size_t calibrationBlobSize = calibrationBlobHeaderSize + 6 * sizeof(T) + 2;
+
+template <typename T> [[nodiscard]] core::Result<size_t> serializeCalibration(const CalibrationData<T>& data, uint8_t* buffer, size_t size) noexcept {
+
+    if(buffer == nullptr) return core::Error(core::ErrorCode::invalidArgument, "Cannot serialize calibration data into a null buffer");
+
+    if(size < calibrationBlobSize<T>) return core::Error(core::ErrorCode::outOfRange, "The given buffer is too small to hold calibration data");
+
+    buffer[0] = static_cast<uint8_t>(calibrationBlobMagic & 0xFF);
+    buffer[1] = static_cast<uint8_t>(calibrationBlobMagic >> 8);
+    buffer[2] = calibrationBlobVersion;
+    buffer[3] = static_cast<uint8_t>(sizeof(T));
+
+    const T values[6] = {data.offset.yaw, data.offset.pitch, data.offset.roll, data.bias.yaw, data.bias.pitch, data.bias.roll};
+    memcpy(buffer + calibrationBlobHeaderSize, values, sizeof(values));
+
+    const size_t crcPos = calibrationBlobSize<T> - 2;
+    const uint16_t crc = crc16(buffer, crcPos);
+
+    buffer[crcPos] = static_cast<uint8_t>(crc & 0xFF);
+    buffer[crcPos + 1] = static_cast<uint8_t>(crc >> 8);
+
+    return calibrationBlobSize<T>;
+}
+
+template <typename T> [[nodiscard]] core::Result<CalibrationData<T>> deserializeCalibration(const uint8_t* buffer, size_t size, const T& maxAbsBias) noexcept {
+
+    if(buffer == nullptr) return core::Error(core::ErrorCode::invalidArgument, "Cannot deserialize calibration data from a null buffer");
+
+    if(size < calibrationBlobSize<T>) return core::Error(core::ErrorCode::outOfRange, "The given buffer is too small to contain calibration data");
+
+    if((buffer[0] | (buffer[1] << 8)) != calibrationBlobMagic) return core::Error(core::ErrorCode::invalidResource, "The calibration blob has no valid signature");
+
+    if(buffer[2] != calibrationBlobVersion) return core::Error(core::ErrorCode::invalidResource, "The calibration blob was written by unsupported format version");
+
+    if(buffer[3] != sizeof(T)) return core::Error(core::ErrorCode::invalidResource, "The calibration blob was written with another scalar type");
+
+    const size_t crcPos = calibrationBlobSize<T> - 2;
+
+    if(crc16(buffer, crcPos) != static_cast<uint16_t>(buffer[crcPos] | (buffer[crcPos + 1] << 8)))
+        return core::Error(core::ErrorCode::invalidResource, "The calibration blob checksum mismatch");
+
+    T values[6];
+    memcpy(values, buffer + calibrationBlobHeaderSize, sizeof(values));
+
+    for(size_t i = 0; i < 6; i++) {
+        if(values[i] != values[i]) return core::Error(core::ErrorCode::invalidResource, "The calibration blob contains NaN values");
+    }
+
+    for(size_t i = 3; i < 6; i++) {
+        if(core::absF(values[i]) > maxAbsBias) return core::Error(core::ErrorCode::outOfRange, "The stored gyro bias is out of sane bounds, recalibration is needed");
+    }
+
+    return CalibrationData<T>{YPR<T>{values[0], values[1], values[2]}, YPR<T>{values[3], values[4], values[5]}};
+}
+
+class CalibrationStorage {
+public:
+    virtual core::Error read(uint8_t* buffer, size_t size) = 0;
+    virtual core::Error write(const uint8_t* buffer, size_t size) = 0;
+    virtual ~CalibrationStorage() = default;
+};
+
+template <typename T> [[nodiscard]] core::Error saveCalibration(CalibrationStorage& storage, const CalibrationData<T>& data) noexcept {
+    uint8_t buffer[calibrationBlobSize<T>];
+
+    core::Result<size_t> size = serializeCalibration(data, buffer, sizeof(buffer));
+    if(size) return size.error();
+
+    return storage.write(buffer, size());
+}
+
+template <typename T> [[nodiscard]] core::Result<CalibrationData<T>> loadCalibration(CalibrationStorage& storage, const T& maxAbsBias) noexcept {
+    uint8_t buffer[calibrationBlobSize<T>];
+
+    core::Error err = storage.read(buffer, sizeof(buffer));
+    if(err) return err;
+
+    return deserializeCalibration(buffer, sizeof(buffer), maxAbsBias);
+}
+
+#if defined(__linux__)
+
+class FileCalibrationStorage : public CalibrationStorage {
+protected:
+    const char* path = nullptr;
+
+public:
+    FileCalibrationStorage(const char* path) noexcept : path(path) {}
+
+    core::Error read(uint8_t* buffer, size_t size) override {
+        FILE* file = fopen(path, "rb");
+        if(file == nullptr) return {core::ErrorCode::invalidResource, "Cannot open calibration file for reading"};
+
+        const size_t got = fread(buffer, 1, size, file);
+        fclose(file);
+
+        if(got != size) return {core::ErrorCode::invalidResource, "The calibration file is truncated"};
+
+        return {};
+    }
+
+    core::Error write(const uint8_t* buffer, size_t size) override {
+        FILE* file = fopen(path, "wb");
+        if(file == nullptr) return {core::ErrorCode::invalidResource, "Cannot open calibration file for writing"};
+
+        const size_t put = fwrite(buffer, 1, size, file);
+        fclose(file);
+
+        if(put != size) return {core::ErrorCode::invalidResource, "Failed writing the calibration file"};
+
+        return {};
+    }
+
+    ~FileCalibrationStorage() override = default;
+};
+
+#endif
+
+} // namespace vislib::gyro
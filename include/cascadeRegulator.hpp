@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vislib.hpp>
+
+#include "pid.hpp"
+
+namespace vislib {
+
+template <typename T, typename TimeType = size_t> struct CascadeStage {
+    PIDRegulator<T, TimeType> pid{};
+    size_t divider = 1;
+    bool isLimited = false;
+    T outputMin{};
+    T outputMax{};
+
+    T output{};
+    int saturation = 0;
+};
+
+// Chain of regulators, stage 0 is the outermost one (e.g. position) and the last stage produces the effort.
+// Every stage output is the setpoint of the next one. A stage with divider k runs every k-th tick and holds its
+// output in between, all stages share the time read once per tick by the caller.
+// A stage stops integrating while it or any stage inside it is saturated in the direction its error pushes,
+// so outer loops don't wind up while the inner ones cannot follow.
+template <typename T, typename TimeType = size_t, size_t Stages = 2> class CascadeRegulator {
+    static_assert(Stages > 0, "Cascade needs at least one stage");
+
+protected:
+    CascadeStage<T, TimeType> stages[Stages]{};
+    size_t tick = 0;
+
+public:
+
+    CascadeRegulator() = default;
+
+    [[nodiscard]] core::Error setStage(size_t index, const PIDRegulator<T, TimeType>& pid, size_t divider = 1) noexcept {
+        if(index >= Stages) return {core::ErrorCode::outOfRange, "The cascade stage index is out of range"};
+
+        if(divider == 0) return {core::ErrorCode::invalidArgument, "The cascade stage rate divider cannot be zero"};
+
+        stages[index].pid = pid;
+        stages[index].divider = divider;
+
+        return {};
+    }
+
+    [[nodiscard]] core::Error setOutputLimits(size_t index, const T& min, const T& max) noexcept {
+        if(index >= Stages) return {core::ErrorCode::outOfRange, "The cascade stage index is out of range"};
+
+        if(max < min) return {core::ErrorCode::invalidArgument, "The cascade stage output limits are inverted"};
+
+        stages[index].isLimited = true;
+        stages[index].outputMin = min;
+        stages[index].outputMax = max;
+
+        return {};
+    }
+
+    // measured holds the feedback of each stage, outermost first
+    [[nodiscard]] T compute(const T (&measured)[Stages], const T& target, const TimeType& time) noexcept(core::numberNoexcept<T, TimeType>()) {
+        T setpoint = target;
+
+        for(size_t i = 0; i < Stages; i++) {
+            CascadeStage<T, TimeType>& stage = stages[i];
+
+            if(tick % stage.divider == 0) {
+                const T error = setpoint - measured[i];
+                const int direction = error > T{} ? 1 : (error < T{} ? -1 : 0);
+
+                bool isBlocked = false;
+                for(size_t j = i; j < Stages; j++) isBlocked = isBlocked || (stages[j].saturation != 0 && stages[j].saturation == direction);
+
+                stage.pid.setIntegration(!isBlocked);
+
+                T output = stage.pid.compute(measured[i], setpoint, time);
+                stage.saturation = 0;
+
+                if(stage.isLimited) {
+                    if(stage.outputMax < output) {
+                        output = stage.outputMax;
+                        stage.saturation = 1;
+                    } else if(output < stage.outputMin) {
+                        output = stage.outputMin;
+                        stage.saturation = -1;
+                    }
+                }
+
+                stage.output = output;
+            }
+
+            setpoint = stage.output;
+        }
+
+        tick++;
+
+        return stages[Stages - 1].output;
+    }
+
+    inline PIDRegulator<T, TimeType>& regulator(size_t index) noexcept {
+        return stages[index < Stages ? index : Stages - 1].pid;
+    }
+
+    inline T getOutput(size_t index) const noexcept {
+        return index < Stages ? stages[index].output : T{};
+    }
+
+    inline int getSaturation(size_t index) const noexcept {
+        return index < Stages ? stages[index].saturation : 0;
+    }
+
+    void reset() noexcept(core::numberNoexcept<T, TimeType>()) {
+        for(size_t i = 0; i < Stages; i++) {
+            stages[i].pid.reset();
+            stages[i].pid.setIntegration(true);
+            stages[i].output = T{};
+            stages[i].saturation = 0;
+        }
+
+        tick = 0;
+    }
+};
+
+} // namespace vislib
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <stdint.h>
+
+namespace vislib {
+
+// CRC-16/CCITT-FALSE, bitwise so it needs no lookup table in flash
+[[nodiscard]] inline uint16_t crc16(const uint8_t* data, size_t size, uint16_t crc = 0xFFFF) noexcept {
+    for(size_t i = 0; i < size; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+} // namespace vislib
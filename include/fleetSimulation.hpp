@@ -0,0 +1,294 @@
+#pragma once
+
+// Host only: relies on std::thread, so it is compiled on Linux builds and is empty elsewhere.
+
+#if defined(__linux__)
+
+#include <vislib.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gyroPLatform.hpp"
+#include "simulation.hpp"
+
+namespace vislib::simulation {
+
+// Every worker owns a deque of index ranges. It pops its own work from the back and, once empty, steals from
+// the front of the others, so uneven robots don't leave cores idle. The calling thread works as the last worker.
+class WorkStealingPool {
+public:
+    using Job = std::function<void(size_t)>;
+
+protected:
+    struct Chunk {
+        const Job* job = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    size_t generation = 0;
+    bool isStopping = false;
+
+    std::atomic<size_t> remaining{0};
+    std::atomic<size_t> steals{0};
+
+    bool takeOwn(size_t worker, Chunk& chunk) {
+        Queue& queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if(queue.chunks.empty()) return false;
+
+        chunk = queue.chunks.back();
+        queue.chunks.pop_back();
+
+        return true;
+    }
+
+    bool steal(size_t worker, Chunk& chunk) {
+        for(size_t i = 1; i < queues.size(); i++) {
+            Queue& queue = *queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if(queue.chunks.empty()) continue;
+
+            chunk = queue.chunks.front();
+            queue.chunks.pop_front();
+            steals.fetch_add(1, std::memory_order_relaxed);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void drain(size_t worker) {
+        Chunk chunk;
+
+        while(takeOwn(worker, chunk) || steal(worker, chunk)) {
+            for(size_t i = chunk.begin; i < chunk.end; i++) (*chunk.job)(i);
+
+            if(remaining.fetch_sub(chunk.end - chunk.begin, std::memory_order_acq_rel) == chunk.end - chunk.begin) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    void workerLoop(size_t worker) {
+        size_t seen = 0;
+
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                wake.wait(lock, [&] { return isStopping || generation != seen; });
+
+                if(isStopping) return;
+
+                seen = generation;
+            }
+
+            drain(worker);
+        }
+    }
+
+public:
+
+    // 0 threads means one per hardware thread, the caller included
+    WorkStealingPool(size_t threads = 0) {
+        if(threads == 0) threads = std::thread::hardware_concurrency();
+        if(threads == 0) threads = 1;
+
+        for(size_t i = 0; i < threads; i++) queues.push_back(std::make_unique<Queue>());
+
+        for(size_t i = 0; i + 1 < threads; i++) workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // runs job(i) for every i in [0, count) and returns once all of them finished
+    void parallelFor(size_t count, const Job& job, size_t grain = 0) {
+        if(count == 0) return;
+
+        if(grain == 0) grain = count / (queues.size() * 4);
+        if(grain == 0) grain = 1;
+
+        remaining.store(count, std::memory_order_release);
+
+        size_t worker = 0;
+        for(size_t begin = 0; begin < count; begin += grain) {
+            Queue& queue = *queues[worker];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            queue.chunks.push_back({&job, begin, core::minF(begin + grain, count)});
+            worker = (worker + 1) % queues.size();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            generation++;
+        }
+        wake.notify_all();
+
+        drain(queues.size() - 1);
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        done.wait(lock, [&] { return remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    inline size_t threadCount() const noexcept {
+        return queues.size();
+    }
+
+    inline size_t getSteals() const noexcept {
+        return steals.load(std::memory_order_relaxed);
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            isStopping = true;
+        }
+        wake.notify_all();
+
+        for(std::thread& worker : workers) worker.join();
+    }
+};
+
+// One simulated robot: gyro platform on a simulated base with its own clock, so robots never share state
+// and stepping them from different threads gives the same result as stepping them one by one.
+class SimulatedRobot {
+public:
+    using Platform_t = platform::StaticGyroPlatform<SimulatedMotorController, double, SimulatedGyro*, SimulationClockHandle<double>>;
+
+    SimulationClock<double> clock{};
+    SimulatedHolonomicBase base{};
+    SimulatedGyro gyro{};
+    Platform_t platform;
+
+    double speed = 0;
+    core::Angle<> direction{};
+    double angularSpeed = 0;
+    bool isDirectionRelative = false;
+
+    SimulatedRobot(
+        const platform::calculators::GyroPidCalculator<double>& calculator,
+        const platform::PlatformMotorConfig& configuration,
+        const SimulatedGyroConfig& gyroConfig = {},
+        double motorTimeConstant = 0) noexcept
+        : gyro(&base, gyroConfig), platform(calculator, &gyro, SimulationClockHandle<double>(&clock), configuration) {
+
+        for(size_t i = 0; i < platform.controllers().Size(); i++) platform.controllers()[i].setTimeConstant(motorTimeConstant);
+    }
+
+    SimulatedRobot(const SimulatedRobot&) = delete;
+    SimulatedRobot& operator=(const SimulatedRobot&) = delete;
+
+    [[nodiscard]] core::Error step(double time, double dt) noexcept {
+        clock = SimulationClock<double>(time);
+
+        core::Error err = platform.go(speed, direction, isDirectionRelative, false, angularSpeed);
+        if(err) return err;
+
+        err = base.step(platform, dt);
+        if(err) return err;
+
+        gyro.step(dt);
+
+        return {};
+    }
+};
+
+// Steps every robot once per tick on the pool, the next tick starts only after all robots finished the current one,
+// so all robots stay on the same simulated time. Robot_t needs core::Error step(double time, double dt).
+template <typename Robot_t = SimulatedRobot> class FleetSimulation {
+protected:
+    std::vector<std::unique_ptr<Robot_t>> fleet;
+    std::vector<core::ErrorCode> errors;
+    WorkStealingPool pool;
+
+    double time = 0;
+    double dt = 0.001;
+
+public:
+
+    FleetSimulation(double dt, size_t threads = 0) : pool(threads), dt(dt) {}
+
+    template <typename... Args> Robot_t& addRobot(Args&&... args) {
+        fleet.push_back(std::make_unique<Robot_t>(std::forward<Args>(args)...));
+        errors.push_back(core::ErrorCode::success);
+
+        return *fleet.back();
+    }
+
+    [[nodiscard]] core::Error step() {
+        if(!(dt > 0)) return {core::ErrorCode::invalidConfiguration, "The simulation step must be positive"};
+
+        const double now = time;
+
+        pool.parallelFor(fleet.size(), [&](size_t i) {
+            errors[i] = fleet[i]->step(now, dt).errcode;
+        });
+
+        time += dt;
+
+        for(size_t i = 0; i < errors.size(); i++) {
+            if(errors[i] != core::ErrorCode::success) {
+                return {errors[i], "Simulated robot " + core::to_string(i) + " failed its step"};
+            }
+        }
+
+        return {};
+    }
+
+    [[nodiscard]] core::Error run(size_t steps) {
+        for(size_t i = 0; i < steps; i++) {
+            core::Error err = step();
+            if(err) return err;
+        }
+
+        return {};
+    }
+
+    inline size_t size() const noexcept {
+        return fleet.size();
+    }
+
+    inline Robot_t& robot(size_t index) noexcept {
+        return *fleet[index];
+    }
+
+    inline core::ErrorCode getError(size_t index) const noexcept {
+        return errors[index];
+    }
+
+    inline double getTime() const noexcept {
+        return time;
+    }
+
+    inline WorkStealingPool& getPool() noexcept {
+        return pool;
+    }
+};
+
+} // namespace vislib::simulation
+
+#endif
@@ -25,6 +25,44 @@ template <typename T> struct YPR {
 template <typename T> using Acceleration = core::Vector<T>;
 template <typename T> using AngularSpeed = core::Vector<T>;
 
+// shortest signed rotation in degrees leading from one angle to another, result lies in [-180, 180)
+template <typename T> [[nodiscard]] inline T shortestAngleDifference(const T& from, const T& to) noexcept(core::numberNoexcept<T>()) {
+    T diff = to - from;
+    
+    return diff - T(360) * floor((diff + T(180)) / T(360));
+}
+
+// accumulates wrapped angle readings into a continuous multi-turn angle
+template <typename T> class AngleUnwrapper {
+protected:
+    T previous{};
+    T continuous{};
+    bool hasPrevious = false;
+    
+public:
+    
+    T update(const T& wrapped) noexcept(core::numberNoexcept<T>()) {
+        continuous = hasPrevious ? continuous + shortestAngleDifference(previous, wrapped) : wrapped;
+        previous = wrapped;
+        hasPrevious = true;
+        
+        return continuous;
+    }
+    
+    inline T get() const noexcept(core::numberNoexcept<T>()) {
+        return continuous;
+    }
+    
+    inline long turns() const noexcept(core::numberNoexcept<T>()) {
+        return static_cast<long>(floor((continuous + T(180)) / T(360)));
+    }
+    
+    inline void reset() noexcept(core::numberNoexcept<T>()) {
+        hasPrevious = false;
+        continuous = T();
+    }
+};
+
 template <typename UpdateParameterType> class BaseGyroController {
 public:
     virtual core::Error update(UpdateParameterType) = 0;
@@ -35,9 +73,16 @@ public:
 template <typename T, typename TimeType = T, typename WT = T> struct YPRElementCalculatorConfig {
     WT integralWeight = WT(1);
     T offset{};
+    T bias{};
     core::Integrator<T, TimeType> integrator{};
     
 };
+
+template <typename T> struct CalibrationData {
+    YPR<T> offset{};
+    YPR<T> bias{};
+};
+
 template <typename YPRType, typename AccAngularSpeedType> class GyroData {
 private:
     using AccT = Acceleration<AccAngularSpeedType>;
@@ -151,13 +196,21 @@ public:
         return internalYawInit(yawConfig);
     }
 
+    inline void setYawBias(const T& bias) noexcept(core::numberNoexcept<T>()) {
+        yawConfig.bias = bias;
+    }
+    
+    inline T getYawBias() const noexcept(core::numberNoexcept<T>()) {
+        return yawConfig.bias;
+    }
+
     virtual core::Result<T> calculateYaw(const TimeType& currentTime)
     noexcept(core::numberNoexcept<T>() && core::numberNoexcept<TimeType>()) {
         
         core::Result<AngularSpeed<T>> angularSpeed = this->getAngularSpeed();
         if(angularSpeed) return angularSpeed.Err();
         
-        core::Result<T> temp = yawConfig.integrator.update(currentTime, angularSpeed().at(0));
+        core::Result<T> temp = yawConfig.integrator.update(currentTime, angularSpeed().at(0) - yawConfig.bias);
         if(temp) return temp.Err();
         
         core::Result<T> nonIntegral = internalNonIntegralPartYawCalculation();
@@ -197,13 +250,21 @@ public:
         return internalPitchInit(pitchConfig);
     }
 
+    inline void setPitchBias(const T& bias) noexcept(core::numberNoexcept<T>()) {
+        pitchConfig.bias = bias;
+    }
+    
+    inline T getPitchBias() const noexcept(core::numberNoexcept<T>()) {
+        return pitchConfig.bias;
+    }
+
     virtual core::Result<T> calculatePitch(const TimeType& currentTime)
     noexcept(core::numberNoexcept<T>() && core::numberNoexcept<TimeType>()) {
         
         core::Result<AngularSpeed<T>> angularSpeed = this->getAngularSpeed();
         if(angularSpeed) return angularSpeed.Err();
         
-        core::Result<T> temp = pitchConfig.integrator.update(currentTime, angularSpeed().at(1));
+        core::Result<T> temp = pitchConfig.integrator.update(currentTime, angularSpeed().at(1) - pitchConfig.bias);
         if(temp) return temp.Err();
         
         core::Result<T> nonIntegral = internalNonIntegralPartPitchCalculation();
@@ -243,13 +304,21 @@ public:
         return internalRollInit(rollConfig);
     }
 
+    inline void setRollBias(const T& bias) noexcept(core::numberNoexcept<T>()) {
+        rollConfig.bias = bias;
+    }
+    
+    inline T getRollBias() const noexcept(core::numberNoexcept<T>()) {
+        return rollConfig.bias;
+    }
+
     virtual core::Result<T> calculateRoll(const TimeType& currentTime)
     noexcept(core::numberNoexcept<T>() && core::numberNoexcept<TimeType>()) {
         
         core::Result<AngularSpeed<T>> angularSpeed = this->getAngularSpeed();
         if(angularSpeed) return angularSpeed.Err();
         
-        core::Result<T> temp = rollConfig.integrator.update(currentTime, angularSpeed().at(2));
+        core::Result<T> temp = rollConfig.integrator.update(currentTime, angularSpeed().at(2) - rollConfig.bias);
         if(temp) return temp.Err();
         
         core::Result<T> nonIntegral = internalNonIntegralPartRollCalculation();
@@ -363,9 +432,22 @@ public:
 template <typename YPRType, typename AccAngularSpeedType> class GyroDataGetter
     : public YPRGetter<YPRType>, virtual public AccelerationGetter<AccAngularSpeedType>, virtual public AngularSpeedGetter<AccAngularSpeedType> {
 
+protected:
+    // caching is off by default, when enabled the controller must call invalidateGyroData() every time its state
+    // changes, otherwise getGyroData() keeps returning the first sample
+    mutable GyroData<YPRType, AccAngularSpeedType> cachedGyroData{};
+    mutable bool isGyroDataCached = false;
+    bool isGyroDataCachingEnabled = false;
+    
+    inline void invalidateGyroData() const noexcept {
+        isGyroDataCached = false;
+    }
+
 public:
     virtual core::Result<GyroData<YPRType, AccAngularSpeedType>> getGyroData() const noexcept(core::numberNoexcept<YPRType>() && core::numberNoexcept<AccAngularSpeedType>()) {
         
+        if(isGyroDataCachingEnabled && isGyroDataCached) return cachedGyroData;
+        
         core::Result<YPR<YPRType>> ypr = this->getYPR();
         if(ypr) return ypr.error();
         
@@ -375,7 +457,21 @@ public:
         core::Result<core::Vector<AccAngularSpeedType>> speed = this->getAngularSpeed();
         if(speed) return speed.error();
         
-        return GyroData<YPRType, AccAngularSpeedType>{ypr(), acceleration(), speed()};
+        if(!isGyroDataCachingEnabled) return GyroData<YPRType, AccAngularSpeedType>{ypr(), acceleration(), speed()};
+        
+        cachedGyroData = GyroData<YPRType, AccAngularSpeedType>{ypr(), acceleration(), speed()};
+        isGyroDataCached = true;
+        
+        return cachedGyroData;
+    }
+    
+    inline void setGyroDataCaching(bool enable) noexcept {
+        isGyroDataCachingEnabled = enable;
+        isGyroDataCached = false;
+    }
+    
+    inline constexpr bool isGyroDataCaching() const noexcept {
+        return isGyroDataCachingEnabled;
     }
     
     virtual ~GyroDataGetter() override = default;
@@ -418,6 +514,44 @@ template <typename YPRType, typename TimeType = YPRType, typename WT = YPRType,
 
 public:
     
+    // every path that changes the calculated angles drops the cached snapshot, so caching enabled with
+    // setGyroDataCaching(true) stays valid for subclasses overriding update() as long as they calculate through these
+    virtual core::Error initYawCalculator(const YPRElementCalculatorConfig<YPRType, TimeType, WT>& config)
+    noexcept(core::numberNoexcept<YPRType>() && core::numberNoexcept<TimeType>()) override {
+        this->invalidateGyroData();
+        return YawCalculator<YPRType, TimeType, WT>::initYawCalculator(config);
+    }
+    
+    virtual core::Error initPitchCalculator(const YPRElementCalculatorConfig<YPRType, TimeType, WT>& config)
+    noexcept(core::numberNoexcept<YPRType>() && core::numberNoexcept<TimeType>()) override {
+        this->invalidateGyroData();
+        return PitchCalculator<YPRType, TimeType, WT>::initPitchCalculator(config);
+    }
+    
+    virtual core::Error initRollCalculator(const YPRElementCalculatorConfig<YPRType, TimeType, WT>& config)
+    noexcept(core::numberNoexcept<YPRType>() && core::numberNoexcept<TimeType>()) override {
+        this->invalidateGyroData();
+        return RollCalculator<YPRType, TimeType, WT>::initRollCalculator(config);
+    }
+    
+    virtual core::Result<YPRType> calculateYaw(const TimeType& currentTime)
+    noexcept(core::numberNoexcept<YPRType>() && core::numberNoexcept<TimeType>()) override {
+        this->invalidateGyroData();
+        return YawCalculator<YPRType, TimeType, WT>::calculateYaw(currentTime);
+    }
+    
+    virtual core::Result<YPRType> calculatePitch(const TimeType& currentTime)
+    noexcept(core::numberNoexcept<YPRType>() && core::numberNoexcept<TimeType>()) override {
+        this->invalidateGyroData();
+        return PitchCalculator<YPRType, TimeType, WT>::calculatePitch(currentTime);
+    }
+    
+    virtual core::Result<YPRType> calculateRoll(const TimeType& currentTime)
+    noexcept(core::numberNoexcept<YPRType>() && core::numberNoexcept<TimeType>()) override {
+        this->invalidateGyroData();
+        return RollCalculator<YPRType, TimeType, WT>::calculateRoll(currentTime);
+    }
+    
     virtual inline vislib::core::Result<YPRType> getYaw() const noexcept override {
         return this->yawConfig.integrator.getIntegral();
     }
@@ -441,11 +575,41 @@ public:
         this->pitchConfig.offset += this->getPitch()();
         this->pitchConfig.integrator.setIntegral(this->pitchConfig.offset);
         
+        this->invalidateGyroData();
+        
+        return {};
+    }
+    
+    virtual CalibrationData<YPRType> exportCalibration() const noexcept {
+        return CalibrationData<YPRType>{
+            YPR<YPRType>{this->yawConfig.offset, this->pitchConfig.offset, this->rollConfig.offset},
+            YPR<YPRType>{this->yawConfig.bias, this->pitchConfig.bias, this->rollConfig.bias}
+        };
+    }
+    
+    virtual core::Error importCalibration(const CalibrationData<YPRType>& data) noexcept {
+        
+        this->yawConfig.offset = data.offset.yaw;
+        this->yawConfig.bias = data.bias.yaw;
+        this->yawConfig.integrator.setIntegral(this->yawConfig.offset);
+        
+        this->pitchConfig.offset = data.offset.pitch;
+        this->pitchConfig.bias = data.bias.pitch;
+        this->pitchConfig.integrator.setIntegral(this->pitchConfig.offset);
+        
+        this->rollConfig.offset = data.offset.roll;
+        this->rollConfig.bias = data.bias.roll;
+        this->rollConfig.integrator.setIntegral(this->rollConfig.offset);
+        
+        this->invalidateGyroData();
+        
         return {};
     }
     
     virtual inline core::Error update(UpdateParameterType currentTime) override {
         auto e = this->calculateYPR(currentTime);
+        
+        this->invalidateGyroData();
 
         if (e) return e.Err();
 
@@ -1,35 +1,148 @@
 #pragma once
 #include "platform.hpp"
+#include "loopProfiler.hpp"
+#include "telemetry.hpp"
+#include "relayAutotuner.hpp"
+#include "lqr.hpp"
+#include "trapezoidalMotion.hpp"
 
 namespace vislib::platform {
     
-template <typename Controller_t, typename Time_t> class GyroPlatform : public Platform<Controller_t> {
+// x, y are the displacement from where the motion starts, along the directions go() takes with isAngleRelative,
+// heading is the absolute yaw to end up with
+struct Pose {
+    double x = 0;
+    double y = 0;
+    core::Angle<> heading{};
+};
+
+template <typename Source_t> struct YawSourceAccess {
+    static inline core::Result<core::Angle<>> getYaw(const Source_t& source) noexcept {
+        return source.getYaw();
+    }
+};
+
+template <typename Source_t> struct YawSourceAccess<Source_t*> {
+    static inline core::Result<core::Angle<>> getYaw(Source_t* const& source) noexcept {
+        return source->getYaw();
+    }
+};
+
+template <typename Source_t> struct YawSourceAccess<core::UniquePtr<Source_t>> {
+    static inline core::Result<core::Angle<>> getYaw(const core::UniquePtr<Source_t>& source) noexcept {
+        return source->getYaw();
+    }
+};
+
+// heading correction and regulator state of the heading calculator for telemetry, the PID calculator exposes
+// its regulator
+template <typename Calculator_t> struct HeadingCalculatorAccess {
+    template <typename Time_t> static inline core::Result<double> correction(Calculator_t& calculator, const Time_t& time, const core::Angle<>& yaw, const core::Angle<>& head) noexcept {
+        return calculator.computeCorrection(time, yaw, head);
+    }
+    
+    template <typename Record_t> static inline void capture(const Calculator_t& calculator, Record_t& record) noexcept {
+        record.pidError = static_cast<float>(calculator.pid.getError());
+        record.pidIntegral = static_cast<float>(calculator.pid.getIntegral());
+        record.pidDerivative = static_cast<float>(calculator.pid.getDerivative());
+        record.pidOutput = static_cast<float>(calculator.pid.getOutput());
+    }
+};
+
+// the LQR reads the measured yaw rate when it has a rate source, it has no integral and its angular speed state
+// takes the place of the derivative
+template <typename TimeType> struct HeadingCalculatorAccess<calculators::GyroLqrCalculator<TimeType>> {
+    static inline core::Result<double> correction(calculators::GyroLqrCalculator<TimeType>& calculator, const TimeType& time, const core::Angle<>& yaw, const core::Angle<>& head) noexcept {
+        return calculator.computeMeasuredCorrection(time, yaw, head);
+    }
+    
+    template <typename Record_t> static inline void capture(const calculators::GyroLqrCalculator<TimeType>& calculator, Record_t& record) noexcept {
+        record.pidError = static_cast<float>(calculator.getError());
+        record.pidIntegral = 0.0f;
+        record.pidDerivative = static_cast<float>(calculator.getAngularSpeed());
+        record.pidOutput = static_cast<float>(calculator.getCorrection());
+    }
+};
+
+// YawSource_t is either a concrete yaw getter held by value, a pointer or a UniquePtr to one,
+// Clock_t is anything callable returning Time_t. Concrete types let the per-tick reads inline.
+// Profiler_t instruments go(), the default one is a no-op unless VISLIB_ROBO_LOOP_PROFILING is defined. A configured
+// profiler, e.g. LoopProfiler(bucketWidth, deadline), can be handed to the constructor.
+// Calculator_t holds the heading, it needs config and computeCorrection(time, yaw, head) as GyroPidCalculator
+// and GyroLqrCalculator have, the LQR one is given its measured yaw rate when it has a rate source.
+// relayTuneStep() works with the PID one only.
+template <typename Controller_t, typename Time_t, typename YawSource_t, typename Clock_t, typename Profiler_t = DefaultLoopProfiler<Time_t>, typename Calculator_t = calculators::GyroPidCalculator<Time_t>>
+class BasicGyroPlatform : public Platform<Controller_t> {
 protected:
-    calculators::GyroPidCalculator<Time_t> calculator{};
-    core::UniquePtr<gyro::YawGetter<core::Angle<>>> yawGetter{};
-    core::TimeGetter<Time_t> timeGetter{};
+    Calculator_t calculator{};
+    YawSource_t yawGetter{};
+    Clock_t timeGetter{};
     core::Angle<> headAngle{};
+    gyro::AngleUnwrapper<double> continuousYaw{};
+    Profiler_t loopProfiler{};
+    
+    Time_t lastTime{};
+    double lastYaw{};
+    PlatformMotorSpeeds lastSpeeds{};
+    core::ErrorCode lastErrcode = core::ErrorCode::success;
     
     bool isSyncHeadWithDir = false;
     
+    TrapezoidalMotionProfile<double, Time_t> moveProfile{};
+    core::Angle<> moveDirection{};
+    double moveDistance = 0;
+    double moveStartHead = 0;
+    double moveTurn = 0;
+    double moveHeadingTolerance = 0;
+    bool isMoveActive = false;
+    
+    // shared by go() and relayTuneStep(): the wheel speeds for the platform angle plus the heading correction,
+    // kept in lastSpeeds until writeSpeeds() applies them
+    core::Error computeSpeeds(const core::Angle<>& angle, const double speed, const double speedK, const double angularSpeed) noexcept {
+        core::Result<PlatformMotorSpeeds> speeds = calculators::calculatePlatformSpeeds(
+            calculator.config,
+            angle.deg(),
+            speed,
+            speedK,
+            angularSpeed
+        );
+        
+        if (speeds.isError()) {
+            lastErrcode = speeds.error().errcode;
+            return speeds.error();
+        }
+        
+        lastSpeeds = core::move(speeds.Value());
+        
+        return {};
+    }
+    
+    core::Error writeSpeeds() noexcept {
+        core::Error err = this->setSpeeds(lastSpeeds);
+        lastErrcode = err.errcode;
+        
+        return err;
+    }
+    
 public:
     
-    GyroPlatform(
-        const calculators::GyroPidCalculator<Time_t>& calculator,
-        core::UniquePtr<gyro::YawGetter<core::Angle<>>>& yawGetter,
-        core::TimeGetter<Time_t>& timeGetter,
+    BasicGyroPlatform(
+        const Calculator_t& calculator,
+        YawSource_t yawGetter,
+        Clock_t timeGetter,
         const PlatformMotorConfig& configuration,
-        size_t parallelismPrecision = 0) noexcept
-        : calculator(calculator), yawGetter(core::move(yawGetter)), timeGetter(core::move(timeGetter)), Platform<Controller_t>(configuration, parallelismPrecision) {
+        size_t parallelismPrecision = 0,
+        Profiler_t loopProfiler = Profiler_t{}) noexcept
+        : Platform<Controller_t>(configuration, parallelismPrecision), calculator(calculator), yawGetter(core::move(yawGetter)), timeGetter(core::move(timeGetter)), loopProfiler(core::move(loopProfiler)) {
         
     }
     
-    GyroPlatform() = default;
-    GyroPlatform(const GyroPlatform&) = default;
-    GyroPlatform(GyroPlatform&&) = default;
-    GyroPlatform& operator=(const GyroPlatform&) = default;
-    GyroPlatform& operator=(GyroPlatform&&) = default;
-    ~GyroPlatform() = default;
+    BasicGyroPlatform() = default;
+    BasicGyroPlatform(const BasicGyroPlatform&) = default;
+    BasicGyroPlatform(BasicGyroPlatform&&) = default;
+    BasicGyroPlatform& operator=(const BasicGyroPlatform&) = default;
+    BasicGyroPlatform& operator=(BasicGyroPlatform&&) = default;
+    ~BasicGyroPlatform() = default;
     
     void setHead(const core::Angle<>& angle) noexcept {
         headAngle = angle;
@@ -39,36 +152,256 @@ public:
         return headAngle;
     }
     
+    // multi-turn yaw in degrees accumulated from the readings taken by go()
+    double getContinuousYaw() const noexcept {
+        return continuousYaw.get();
+    }
+    
+    Profiler_t& profiler() noexcept {
+        return loopProfiler;
+    }
+    
+    const Profiler_t& profiler() const noexcept {
+        return loopProfiler;
+    }
+    
+    // copies the state of the last go() call, cheap enough to be pushed into a telemetry::RingBuffer every tick
+    template <size_t Motors> void captureTelemetry(telemetry::ControlRecord<Time_t, Motors>& record) const noexcept {
+        record.time = lastTime;
+        record.yaw = static_cast<float>(lastYaw);
+        record.head = static_cast<float>(headAngle.deg());
+        HeadingCalculatorAccess<Calculator_t>::capture(calculator, record);
+        
+        for(size_t i = 0; i < Motors; i++) {
+            record.speeds[i] = i < lastSpeeds.Size() ? static_cast<float>(lastSpeeds[i]) : 0.0f;
+        }
+        
+        record.errcode = static_cast<uint16_t>(lastErrcode);
+    }
+    
     core::Error go(const double speed, const core::Angle<>& angle, bool isAngleRelative = false,  bool enableHeadSync = false, const double angularSpeed = 0, const double speedK = 1) noexcept {
         
+        LoopTickGuard<Profiler_t, Clock_t> tick(loopProfiler, timeGetter);
+        
         auto time = timeGetter();
+        lastTime = time;
         
-        core::Result<core::Angle<>> yaw = yawGetter->getYaw();
-        if(yaw.isError()) return yaw.error();
+        loopProfiler.mark(LoopStage::timeRead, timeGetter);
+        
+        core::Result<core::Angle<>> yaw = YawSourceAccess<YawSource_t>::getYaw(yawGetter);
+        if(yaw.isError()) {
+            lastErrcode = yaw.error().errcode;
+            return yaw.error();
+        }
+        
+        loopProfiler.mark(LoopStage::yawRead, timeGetter);
+        
+        lastYaw = yaw().deg();
+        continuousYaw.update(lastYaw);
         
         if(enableHeadSync) {
             headAngle = angle;
         }
         
-        core::Result<PlatformMotorSpeeds> speeds = calculator.calculateSpeeds(
-            time,
-            isAngleRelative ? yaw() - angle : angle,
-            yaw.Value(),
-            headAngle,
-            speed,
-            speedK,
-            angularSpeed
-        );
+        core::Result<double> correction = HeadingCalculatorAccess<Calculator_t>::correction(calculator, time, yaw.Value(), headAngle);
+        if(correction) {
+            lastErrcode = correction.error().errcode;
+            return correction.error();
+        }
         
-        if (speeds.isError()) return speeds.error();
+        loopProfiler.mark(LoopStage::pid, timeGetter);
+        
+        core::Error err = computeSpeeds(isAngleRelative ? yaw() - angle : angle, speed, speedK, angularSpeed + correction());
+        if(err.isError()) return err;
         
-        core::Error err = this->setSpeeds(speeds());
+        loopProfiler.mark(LoopStage::speedCalculation, timeGetter);
+        
+        err = writeSpeeds();
+        
+        loopProfiler.mark(LoopStage::setSpeeds, timeGetter);
         
         if(err.isError()) return err;
         
         return {};
     }
     
+    // One tick of the relay autotune experiment on heading, the relay output replaces the PID correction.
+    // The tuner must be started with setpoint 0, it sees the heading error the regulator would see.
+    // Once the experiment finishes the tuned gains are written into the heading regulator, only on the tick it
+    // finishes so later ticks don't reset the regulator again, and true is returned.
+    [[nodiscard]] core::Result<bool> relayTuneStep(RelayAutotuner<double, Time_t>& tuner, const double speed = 0, const core::Angle<>& angle = core::Angle<>(0.0), bool isAngleRelative = false) noexcept {
+        
+        auto time = timeGetter();
+        lastTime = time;
+        
+        core::Result<core::Angle<>> yaw = YawSourceAccess<YawSource_t>::getYaw(yawGetter);
+        if(yaw.isError()) {
+            lastErrcode = yaw.error().errcode;
+            return yaw.error();
+        }
+        
+        lastYaw = yaw().deg();
+        continuousYaw.update(lastYaw);
+        
+        const bool wasFinished = tuner.isFinished();
+        
+        core::Result<double> relay = tuner.update(-gyro::shortestAngleDifference(yaw().deg(), headAngle.deg()), time);
+        if(relay) {
+            lastErrcode = relay.error().errcode;
+            return relay.error();
+        }
+        
+        if(!wasFinished && tuner.isFinished()) {
+            core::Error err = tuner.applyTo(calculator.pid);
+            lastErrcode = err.errcode;
+            
+            if(err) return err;
+        }
+        
+        core::Error err = computeSpeeds(isAngleRelative ? yaw() - angle : angle, speed, 1, relay());
+        if(err.isError()) return err;
+        
+        err = writeSpeeds();
+        if(err.isError()) return err;
+        
+        return tuner.isFinished();
+    }
+    
+    // Plans a straight line motion to the pose: one trapezoidal profile over the distance, the held heading is
+    // turned along with the traveled part of it. Nothing is moved until moveStep() is called.
+    [[nodiscard]] core::Error moveTo(const Pose& target, const double acceleration, const double speedLimit, const double headingTolerance = 1) noexcept {
+        isMoveActive = false;
+        
+        if(this->_controllers.Size() != calculator.config.Size()) {
+            return {core::ErrorCode::invalidConfiguration, "The heading calculator config and the platform controllers have different amounts of motors"};
+        }
+        
+        moveDistance = hypot(target.x, target.y);
+        moveDirection = core::Angle<>(core::rad2Deg(atan2(target.y, target.x)));
+        moveStartHead = headAngle.deg();
+        moveTurn = gyro::shortestAngleDifference(moveStartHead, target.heading.deg());
+        moveHeadingTolerance = headingTolerance;
+        
+        moveProfile.setLimits(acceleration, speedLimit);
+        
+        if(moveDistance > 0) {
+            core::Error err = moveProfile.startMotion(0, moveDistance, timeGetter());
+            if(err) return err;
+        }
+        
+        // sized once here, the ticks fill it in place and setSpeeds() reads it by reference
+        if(lastSpeeds.Size() != calculator.config.Size()) lastSpeeds = PlatformMotorSpeeds(calculator.config.Size());
+        
+        isMoveActive = true;
+        
+        return {};
+    }
+    
+    // One tick of the motion planned by moveTo(): evaluates the profile, holds the interpolated heading and
+    // applies the wheel speeds through setSpeeds() like go() does. Returns true once the profile has ended and the
+    // heading is within the tolerance, the platform is left holding the target heading at zero speed.
+    [[nodiscard]] core::Result<bool> moveStep() noexcept {
+        if(!isMoveActive) return core::Error(core::ErrorCode::invalidConfiguration, "No motion was planned with moveTo()");
+        
+        auto time = timeGetter();
+        lastTime = time;
+        
+        core::Result<core::Angle<>> yaw = YawSourceAccess<YawSource_t>::getYaw(yawGetter);
+        if(yaw.isError()) {
+            lastErrcode = yaw.error().errcode;
+            return yaw.error();
+        }
+        
+        lastYaw = yaw().deg();
+        continuousYaw.update(lastYaw);
+        
+        double speed = 0;
+        double progress = 1;
+        bool isProfileFinished = true;
+        
+        if(moveDistance > 0) {
+            core::Result<TMPResult<double>> motion = moveProfile.calculateMotion(time);
+            if(motion) {
+                lastErrcode = motion.error().errcode;
+                return motion.error();
+            }
+            
+            speed = motion().speed;
+            progress = motion().position / moveDistance;
+            isProfileFinished = moveProfile.isFinished(time);
+        }
+        
+        headAngle = core::Angle<>(moveStartHead + moveTurn * progress);
+        
+        core::Result<double> correction = HeadingCalculatorAccess<Calculator_t>::correction(calculator, time, yaw(), headAngle);
+        if(correction) {
+            lastErrcode = correction.error().errcode;
+            return correction.error();
+        }
+        const double angle = (yaw() - moveDirection).deg();
+        
+        for(size_t i = 0; i < lastSpeeds.Size(); i++) {
+            core::Result<motor::Speed> linear = calculators::calculateMotorLinearSpeed(calculator.config[i], angle, speed);
+            if(linear) {
+                lastErrcode = linear.error().errcode;
+                return linear.error();
+            }
+            
+            lastSpeeds[i] = linear() + calculators::calculateMotorSpeedLinearFromAngular(calculator.config[i], correction());
+        }
+        
+        core::Error err = writeSpeeds();
+        if(err.isError()) return err;
+        
+        const bool isDone = isProfileFinished && core::absF(gyro::shortestAngleDifference(lastYaw, headAngle.deg())) <= moveHeadingTolerance;
+        
+        if(isDone) {
+            moveProfile.endMotion();
+            isMoveActive = false;
+        }
+        
+        return isDone;
+    }
+    
+    inline bool isMoving() const noexcept {
+        return isMoveActive;
+    }
+    
+    // abandons the planned motion, the speeds written by the last tick stay applied
+    void stopMove() noexcept {
+        moveProfile.endMotion();
+        isMoveActive = false;
+    }
+    
 };
 
+template <typename Controller_t, typename Time_t> class GyroPlatform
+    : public BasicGyroPlatform<Controller_t, Time_t, core::UniquePtr<gyro::YawGetter<core::Angle<>>>, core::TimeGetter<Time_t>> {
+    
+    using Base = BasicGyroPlatform<Controller_t, Time_t, core::UniquePtr<gyro::YawGetter<core::Angle<>>>, core::TimeGetter<Time_t>>;
+    
+public:
+    
+    GyroPlatform(
+        const calculators::GyroPidCalculator<Time_t>& calculator,
+        core::UniquePtr<gyro::YawGetter<core::Angle<>>>& yawGetter,
+        core::TimeGetter<Time_t>& timeGetter,
+        const PlatformMotorConfig& configuration,
+        size_t parallelismPrecision = 0) noexcept
+        : Base(calculator, core::move(yawGetter), core::move(timeGetter), configuration, parallelismPrecision) {
+        
+    }
+    
+    GyroPlatform() = default;
+    GyroPlatform(const GyroPlatform&) = default;
+    GyroPlatform(GyroPlatform&&) = default;
+    GyroPlatform& operator=(const GyroPlatform&) = default;
+    GyroPlatform& operator=(GyroPlatform&&) = default;
+    ~GyroPlatform() = default;
+};
+
+// the yaw source and the clock are stored by value and called without virtual dispatch or heap allocation
+template <typename Controller_t, typename Time_t, typename YawSource_t, typename Clock_t, typename Profiler_t = DefaultLoopProfiler<Time_t>, typename Calculator_t = calculators::GyroPidCalculator<Time_t>>
+using StaticGyroPlatform = BasicGyroPlatform<Controller_t, Time_t, YawSource_t, Clock_t, Profiler_t, Calculator_t>;
+
 } //vislib::platform
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vislib.hpp>
+
+#include "gyro.hpp"
+#include "platform.hpp"
+
+namespace vislib::platform {
+
+// rates are in degrees per time unit of the filter, noises are variances accumulated per time unit
+struct HeadingFilterConfig {
+    double headingNoise = 0.01;
+    double biasNoise = 1e-6;
+    double odometryNoise = 4;
+    double initialBiasVariance = 1;
+    double wheelRateScale = 1;
+    double innovationGate = 3;
+};
+
+namespace calculators {
+
+// inverse of calculateMotorSpeedLinearFromAngular averaged over wheels, translation cancels out on symmetric layouts
+[[nodiscard]] inline core::Result<double> calculateAngularSpeedFromMotors(const PlatformMotorConfig& config, const PlatformMotorSpeeds& speeds) noexcept {
+    if(config.Size() == 0 || speeds.Size() != config.Size()) {
+        return core::Error(core::ErrorCode::invalidArgument, "Cannot estimate angular speed from motor speeds as motor config and speeds sizes differ");
+    }
+
+    double sum = 0;
+
+    for(size_t i = 0; i < config.Size(); i++) {
+        if(config[i].distance == 0) {
+            return core::Error(core::ErrorCode::invalidConfiguration, "Cannot estimate angular speed from a motor placed in the platform center");
+        }
+
+        sum += speeds[i] * (config[i].wheelR != 0 ? config[i].wheelR : 1) / config[i].distance;
+    }
+
+    return sum / config.Size();
+}
+
+} // namespace vislib::platform::calculators
+
+// Two state [heading, gyro bias] Kalman filter. Gyro rate drives the prediction, while the difference between
+// gyro rate and wheel odometry rate observes the bias. Implements YawGetter, so it can be handed to GyroPlatform.
+template <typename TimeType> class HeadingKalmanFilter : public gyro::YawGetter<core::Angle<>> {
+protected:
+    HeadingFilterConfig filterConfig{};
+    PlatformMotorConfig config;
+
+    double heading{};
+    double bias{};
+
+    double p00{};
+    double p01{};
+    double p11{};
+
+    TimeType prevTime{};
+    bool hasTime = false;
+
+public:
+
+    HeadingKalmanFilter() = default;
+
+    HeadingKalmanFilter(const PlatformMotorConfig& config, const HeadingFilterConfig& filterConfig = {}, const core::Angle<>& initialHeading = {}) noexcept
+    : filterConfig(filterConfig), config(config), heading(initialHeading.deg()), p11(filterConfig.initialBiasVariance) {}
+
+    [[nodiscard]] core::Error update(const TimeType& time, const double gyroRate, const double wheelRate) noexcept {
+
+        if(!hasTime) {
+            prevTime = time;
+            hasTime = true;
+            return {};
+        }
+
+        const double dt = static_cast<double>(time - prevTime);
+        prevTime = time;
+
+        if(dt <= 0) return {};
+
+        heading += (gyroRate - bias) * dt;
+
+        p00 += dt * (dt * p11 - 2 * p01) + filterConfig.headingNoise * dt;
+        p01 -= dt * p11;
+        p11 += filterConfig.biasNoise * dt;
+
+        const double s = p11 + filterConfig.odometryNoise;
+        const double innovation = gyroRate - wheelRate * filterConfig.wheelRateScale - bias;
+
+        if(innovation * innovation > filterConfig.innovationGate * filterConfig.innovationGate * s) return {};
+
+        const double k0 = p01 / s;
+        const double k1 = p11 / s;
+
+        heading += k0 * innovation;
+        bias += k1 * innovation;
+
+        p00 -= k0 * p01;
+        p01 -= k0 * p11;
+        p11 -= k1 * p11;
+
+        return {};
+    }
+
+    [[nodiscard]] core::Error update(const TimeType& time, const double gyroRate, const PlatformMotorSpeeds& wheelSpeeds) noexcept {
+        core::Result<double> wheelRate = calculators::calculateAngularSpeedFromMotors(config, wheelSpeeds);
+        if(wheelRate) return wheelRate.error();
+
+        return update(time, gyroRate, wheelRate());
+    }
+
+    [[nodiscard]] core::Error update(const TimeType& time, const gyro::AngularSpeedGetter<double>& gyro, const PlatformMotorSpeeds& wheelSpeeds) noexcept {
+        core::Result<gyro::AngularSpeed<double>> speed = gyro.getAngularSpeed();
+        if(speed) return speed.error();
+
+        return update(time, speed().at(0), wheelSpeeds);
+    }
+
+    core::Result<core::Angle<>> getYaw() const noexcept override {
+        return core::Angle<>(heading);
+    }
+
+    inline double getBias() const noexcept {
+        return bias;
+    }
+
+    inline double getHeadingVariance() const noexcept {
+        return p00;
+    }
+
+    inline void reset(const core::Angle<>& newHeading) noexcept {
+        heading = newHeading.deg();
+        p00 = 0;
+        p01 = 0;
+    }
+
+    ~HeadingKalmanFilter() override = default;
+};
+
+} //vislib::platform
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <vislib.hpp>
+
+#include "gyro.hpp"
+
+namespace vislib::gyro {
+
+// second order IIR section in transposed direct form II, coefficients follow the RBJ audio EQ cookbook
+template <typename T> class Biquad {
+protected:
+    T b0 = T(1);
+    T b1{};
+    T b2{};
+    T a1{};
+    T a2{};
+
+    T z1{};
+    T z2{};
+
+    static constexpr double pi = 3.14159265358979323846;
+
+    static core::Error checkFrequency(const T& sampleRate, const T& frequency, const T& q) noexcept(core::numberNoexcept<T>()) {
+        if(sampleRate <= T()) return {core::ErrorCode::invalidArgument, "Filter sample rate must be positive"};
+
+        if(frequency <= T() || frequency * T(2) >= sampleRate) return {core::ErrorCode::outOfRange, "Filter frequency must lie between zero and the Nyquist frequency"};
+
+        if(q <= T()) return {core::ErrorCode::invalidArgument, "Filter quality factor must be positive"};
+
+        return {};
+    }
+
+public:
+
+    Biquad() = default;
+
+    Biquad(const T& b0, const T& b1, const T& b2, const T& a1, const T& a2) noexcept(core::numberNoexcept<T>())
+    : b0(b0), b1(b1), b2(b2), a1(a1), a2(a2) {}
+
+    [[nodiscard]] static core::Result<Biquad<T>> lowPass(const T& sampleRate, const T& cutoff, const T& q = T(0.7071067811865476)) noexcept(core::numberNoexcept<T>()) {
+        core::Error err = checkFrequency(sampleRate, cutoff, q);
+        if(err) return err;
+
+        const T w0 = T(2 * pi) * cutoff / sampleRate;
+        const T c = cos(w0);
+        const T alpha = sin(w0) / (T(2) * q);
+        const T a0 = T(1) + alpha;
+
+        return Biquad<T>((T(1) - c) / T(2) / a0, (T(1) - c) / a0, (T(1) - c) / T(2) / a0, T(-2) * c / a0, (T(1) - alpha) / a0);
+    }
+
+    [[nodiscard]] static core::Result<Biquad<T>> notch(const T& sampleRate, const T& center, const T& q) noexcept(core::numberNoexcept<T>()) {
+        core::Error err = checkFrequency(sampleRate, center, q);
+        if(err) return err;
+
+        const T w0 = T(2 * pi) * center / sampleRate;
+        const T c = cos(w0);
+        const T alpha = sin(w0) / (T(2) * q);
+        const T a0 = T(1) + alpha;
+
+        return Biquad<T>(T(1) / a0, T(-2) * c / a0, T(1) / a0, T(-2) * c / a0, (T(1) - alpha) / a0);
+    }
+
+    inline T process(const T& x) noexcept(core::numberNoexcept<T>()) {
+        const T y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+
+        return y;
+    }
+
+    // primes the state as if the input had been constant forever, avoiding the start-up transient
+    inline void reset(const T& value = T()) noexcept(core::numberNoexcept<T>()) {
+        const T y = value * (b0 + b1 + b2) / (T(1) + a1 + a2);
+        z1 = y - b0 * value;
+        z2 = b2 * value - a2 * y;
+    }
+};
+
+template <typename T, size_t Stages> class BiquadChain {
+    static_assert(Stages > 0, "Biquad chain requires at least one stage");
+
+protected:
+    Biquad<T> stages[Stages]{};
+
+public:
+
+    BiquadChain() = default;
+
+    [[nodiscard]] core::Error setStage(size_t index, const Biquad<T>& stage) noexcept(core::numberNoexcept<T>()) {
+        if(index >= Stages) return {core::ErrorCode::outOfRange, "The filter stage index " + core::to_string(index) + " is out of chain range"};
+
+        stages[index] = stage;
+
+        return {};
+    }
+
+    inline T process(T x) noexcept(core::numberNoexcept<T>()) {
+        for(size_t i = 0; i < Stages; i++) x = stages[i].process(x);
+
+        return x;
+    }
+
+    inline void reset(const T& value = T()) noexcept(core::numberNoexcept<T>()) {
+        T x = value;
+
+        for(size_t i = 0; i < Stages; i++) {
+            stages[i].reset(x);
+            x = stages[i].process(x);
+        }
+    }
+};
+
+// first order CIC (integrate and dump) decimator, emits the block mean every Factor samples
+template <typename T, size_t Factor> class Decimator {
+    static_assert(Factor > 0, "Decimation factor must be positive");
+
+protected:
+    T accumulator{};
+    T output{};
+    size_t counter = 0;
+
+public:
+
+    inline bool process(const T& x) noexcept(core::numberNoexcept<T>()) {
+        accumulator += x;
+
+        if(++counter < Factor) return false;
+
+        output = accumulator / T(Factor);
+        accumulator = T();
+        counter = 0;
+
+        return true;
+    }
+
+    inline T get() const noexcept(core::numberNoexcept<T>()) {
+        return output;
+    }
+
+    inline void reset() noexcept(core::numberNoexcept<T>()) {
+        accumulator = T();
+        output = T();
+        counter = 0;
+    }
+};
+
+// per-axis biquad chain followed by decimation, vectors are filtered in place of the raw sensor vectors
+template <typename T, size_t Stages, size_t Factor = 1, size_t Axes = 3> class VectorFilterChain {
+protected:
+    BiquadChain<T, Stages> chains[Axes]{};
+    Decimator<T, Factor> decimators[Axes]{};
+    core::Vector<T> output{};
+    bool hasOutput = false;
+    bool isPrimed = false;
+
+public:
+
+    [[nodiscard]] core::Error setStage(size_t index, const Biquad<T>& stage) noexcept(core::numberNoexcept<T>()) {
+        for(size_t axis = 0; axis < Axes; axis++) {
+            core::Error err = chains[axis].setStage(index, stage);
+            if(err) return err;
+        }
+
+        isPrimed = false;
+
+        return {};
+    }
+
+    [[nodiscard]] core::Result<bool> process(const core::Vector<T>& input) noexcept(core::numberNoexcept<T>()) {
+        if(input.Size() < Axes) return core::Error(core::ErrorCode::invalidArgument, "The filtered vector has fewer axes than the filter chain");
+
+        if(!isPrimed) {
+            for(size_t axis = 0; axis < Axes; axis++) chains[axis].reset(input[axis]);
+            output = input;
+            isPrimed = true;
+        }
+
+        bool isReady = false;
+
+        for(size_t axis = 0; axis < Axes; axis++) {
+            isReady = decimators[axis].process(chains[axis].process(input[axis]));
+        }
+
+        if(!isReady) return false;
+
+        for(size_t axis = 0; axis < Axes; axis++) output[axis] = decimators[axis].get();
+
+        hasOutput = true;
+
+        return true;
+    }
+
+    [[nodiscard]] core::Result<core::Vector<T>> get() const noexcept(core::numberNoexcept<T>()) {
+        if(!hasOutput) return core::Error(core::ErrorCode::invalidResource, "The filter chain hasn't produced any output yet");
+
+        return output;
+    }
+};
+
+// sits between a raw sensor getter and the calculators, update() must be called at the sensor sample rate
+template <typename T, size_t Stages, size_t Factor = 1> class FilteredAngularSpeedGetter : virtual public AngularSpeedGetter<T> {
+protected:
+    const AngularSpeedGetter<T>* source = nullptr;
+    VectorFilterChain<T, Stages, Factor> filter{};
+
+public:
+
+    FilteredAngularSpeedGetter() = default;
+
+    FilteredAngularSpeedGetter(const AngularSpeedGetter<T>* source) noexcept : source(source) {}
+
+    [[nodiscard]] core::Error setStage(size_t index, const Biquad<T>& stage) noexcept(core::numberNoexcept<T>()) {
+        return filter.setStage(index, stage);
+    }
+
+    [[nodiscard]] core::Result<bool> update() noexcept(core::numberNoexcept<T>()) {
+        if(source == nullptr) return core::Error(core::ErrorCode::invalidResource, "The filtered angular speed source is not set");
+
+        core::Result<AngularSpeed<T>> speed = source->getAngularSpeed();
+        if(speed) return speed.error();
+
+        return filter.process(speed());
+    }
+
+    core::Result<AngularSpeed<T>> getAngularSpeed() const noexcept(core::numberNoexcept<T>()) override {
+        return filter.get();
+    }
+
+    virtual ~FilteredAngularSpeedGetter() override = default;
+};
+
+template <typename T, size_t Stages, size_t Factor = 1> class FilteredAccelerationGetter : virtual public AccelerationGetter<T> {
+protected:
+    const AccelerationGetter<T>* source = nullptr;
+    VectorFilterChain<T, Stages, Factor> filter{};
+
+public:
+
+    FilteredAccelerationGetter() = default;
+
+    FilteredAccelerationGetter(const AccelerationGetter<T>* source) noexcept : source(source) {}
+
+    [[nodiscard]] core::Error setStage(size_t index, const Biquad<T>& stage) noexcept(core::numberNoexcept<T>()) {
+        return filter.setStage(index, stage);
+    }
+
+    [[nodiscard]] core::Result<bool> update() noexcept(core::numberNoexcept<T>()) {
+        if(source == nullptr) return core::Error(core::ErrorCode::invalidResource, "The filtered acceleration source is not set");
+
+        core::Result<Acceleration<T>> acceleration = source->getAcceleration();
+        if(acceleration) return acceleration.error();
+
+        return filter.process(acceleration());
+    }
+
+    core::Result<Acceleration<T>> getAcceleration() const noexcept(core::numberNoexcept<T>()) override {
+        return filter.get();
+    }
+
+    virtual ~FilteredAccelerationGetter() override = default;
+};
+
+} // namespace vislib::gyro
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <vislib.hpp>
+
+#include "gyro.hpp"
+
+namespace vislib::gyro {
+
+// Fuses N redundant IMUs axis by axis: readings further than the rejection threshold from the per-axis median
+// are masked out and the rest are averaged with per-sensor weights. Failed sensors are skipped, so the fused
+// getters keep working while at least one source is alive.
+// With only two valid readings the median is their midpoint and can't single out a faulty one, so two readings
+// further apart than the threshold keep the one closer to the previous fused value (the higher weighted one when
+// there is none yet) and the sample is flagged as a fault.
+template <typename T, size_t N> class RedundantImuFusion : virtual public AngularSpeedGetter<T>, virtual public AccelerationGetter<T> {
+    static_assert(N > 0, "Redundant IMU fusion requires at least one source");
+
+protected:
+    struct FusionState {
+        core::Vector<T> previous{};
+        bool hasPrevious = false;
+        bool isFault = false;
+    };
+
+    const AngularSpeedGetter<T>* speedSources[N]{};
+    const AccelerationGetter<T>* accelerationSources[N]{};
+    T weights[N]{};
+
+    T speedRejectionThreshold{};
+    T accelerationRejectionThreshold{};
+
+    mutable size_t rejectedSamples[N]{};
+    mutable FusionState speedState{};
+    mutable FusionState accelerationState{};
+
+    static T median(T (&values)[N], size_t count) noexcept(core::numberNoexcept<T>()) {
+        for(size_t i = 1; i < count; i++) {
+            T value = values[i];
+            size_t j = i;
+
+            for(; j > 0 && values[j - 1] > value; j--) values[j] = values[j - 1];
+
+            values[j] = value;
+        }
+
+        return count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / T(2);
+    }
+
+    // picks the source kept when two valid readings disagree on the axis
+    size_t resolvePair(const core::Vector<T> (&readings)[N], size_t a, size_t b, size_t axis, const FusionState& state) const noexcept(core::numberNoexcept<T>()) {
+        if(state.hasPrevious && axis < state.previous.Size()) {
+            const T previous = state.previous[axis];
+
+            return core::absF(readings[b][axis] - previous) < core::absF(readings[a][axis] - previous) ? b : a;
+        }
+
+        return weights[b] > weights[a] ? b : a;
+    }
+
+    core::Result<core::Vector<T>> fuse(const core::Vector<T> (&readings)[N], const bool (&isValid)[N], const T& threshold, FusionState& state) const noexcept(core::numberNoexcept<T>()) {
+
+        size_t first = N;
+        size_t second = N;
+        size_t valid = 0;
+        size_t axes = 0;
+
+        for(size_t k = 0; k < N; k++) {
+            if(!isValid[k]) continue;
+
+            if(first == N) {
+                first = k;
+                axes = readings[k].Size();
+            } else if(second == N) {
+                second = k;
+            }
+
+            axes = core::minF(axes, readings[k].Size());
+            valid++;
+        }
+
+        if(first == N) return core::Error(core::ErrorCode::invalidResource, "None of the fused IMU sources returned valid data");
+
+        core::Vector<T> result = readings[first];
+        bool isRejected[N]{};
+
+        for(size_t axis = 0; axis < axes; axis++) {
+            if(valid == 2) {
+                const T a = readings[first][axis];
+                const T b = readings[second][axis];
+
+                if(core::absF(a - b) <= threshold) {
+                    const T weightSum = weights[first] + weights[second];
+                    result[axis] = weightSum > T() ? (weights[first] * a + weights[second] * b) / weightSum : (a + b) / T(2);
+                } else {
+                    const size_t kept = resolvePair(readings, first, second, axis, state);
+
+                    isRejected[kept == first ? second : first] = true;
+                    result[axis] = readings[kept][axis];
+                }
+
+                continue;
+            }
+
+            T values[N]{};
+            T sorted[N]{};
+            T mask[N]{};
+            size_t count = 0;
+
+            for(size_t k = 0; k < N; k++) {
+                if(!isValid[k]) continue;
+
+                values[k] = readings[k][axis];
+                mask[k] = T(1);
+                sorted[count++] = values[k];
+            }
+
+            const T center = median(sorted, count);
+
+            T weightSum{};
+            T sum{};
+
+            for(size_t k = 0; k < N; k++) {
+                const T inlier = T(core::absF(values[k] - center) <= threshold);
+                const T w = weights[k] * mask[k] * inlier;
+
+                if(mask[k] > T() && inlier == T()) isRejected[k] = true;
+
+                weightSum += w;
+                sum += w * values[k];
+            }
+
+            result[axis] = weightSum > T() ? sum / weightSum : center;
+        }
+
+        state.isFault = false;
+
+        for(size_t k = 0; k < N; k++) {
+            if(!isRejected[k]) continue;
+
+            rejectedSamples[k]++;
+            state.isFault = true;
+        }
+
+        state.previous = result;
+        state.hasPrevious = true;
+
+        return result;
+    }
+
+public:
+
+    RedundantImuFusion(const T& speedRejectionThreshold, const T& accelerationRejectionThreshold) noexcept(core::numberNoexcept<T>())
+    : speedRejectionThreshold(speedRejectionThreshold), accelerationRejectionThreshold(accelerationRejectionThreshold) {}
+
+    [[nodiscard]] core::Error setSource(size_t index, const AngularSpeedGetter<T>* speedSource, const AccelerationGetter<T>* accelerationSource, const T& weight = T(1)) noexcept(core::numberNoexcept<T>()) {
+        if(index >= N) return {core::ErrorCode::outOfRange, "The IMU source index " + core::to_string(index) + " is out of fusion range"};
+
+        if(weight < T()) return {core::ErrorCode::invalidArgument, "The IMU source weight cannot be negative"};
+
+        speedSources[index] = speedSource;
+        accelerationSources[index] = accelerationSource;
+        weights[index] = weight;
+        rejectedSamples[index] = 0;
+
+        return {};
+    }
+
+    core::Result<AngularSpeed<T>> getAngularSpeed() const noexcept(core::numberNoexcept<T>()) override {
+        AngularSpeed<T> readings[N]{};
+        bool isValid[N]{};
+
+        for(size_t k = 0; k < N; k++) {
+            if(speedSources[k] == nullptr) continue;
+
+            core::Result<AngularSpeed<T>> reading = speedSources[k]->getAngularSpeed();
+            if(reading) continue;
+
+            readings[k] = core::move(reading.Value());
+            isValid[k] = true;
+        }
+
+        return fuse(readings, isValid, speedRejectionThreshold, speedState);
+    }
+
+    core::Result<Acceleration<T>> getAcceleration() const noexcept(core::numberNoexcept<T>()) override {
+        Acceleration<T> readings[N]{};
+        bool isValid[N]{};
+
+        for(size_t k = 0; k < N; k++) {
+            if(accelerationSources[k] == nullptr) continue;
+
+            core::Result<Acceleration<T>> reading = accelerationSources[k]->getAcceleration();
+            if(reading) continue;
+
+            readings[k] = core::move(reading.Value());
+            isValid[k] = true;
+        }
+
+        return fuse(readings, isValid, accelerationRejectionThreshold, accelerationState);
+    }
+
+    inline size_t getRejectedSamples(size_t index) const noexcept {
+        return index < N ? rejectedSamples[index] : 0;
+    }
+
+    // whether a source was rejected in the last fused sample
+    inline bool hasSpeedFault() const noexcept {
+        return speedState.isFault;
+    }
+
+    inline bool hasAccelerationFault() const noexcept {
+        return accelerationState.isFault;
+    }
+
+    virtual ~RedundantImuFusion() override = default;
+};
+
+} // namespace vislib::gyro
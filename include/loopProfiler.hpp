@@ -0,0 +1,218 @@
+#pragma once
+
+#include <vislib.hpp>
+
+namespace vislib::platform {
+
+#ifndef VISLIB_ROBO_PROFILER_BUCKETS
+#define VISLIB_ROBO_PROFILER_BUCKETS 16
+#endif
+
+// fixed width buckets, the last one collects everything above Buckets * bucketWidth
+template <typename Time_t, size_t Buckets> class LatencyHistogram {
+protected:
+    Time_t bucketWidth{};
+    size_t buckets[Buckets + 1]{};
+    size_t samples = 0;
+    Time_t maxValue{};
+
+public:
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const Time_t& bucketWidth) noexcept : bucketWidth(bucketWidth) {}
+
+    inline void record(const Time_t& value) noexcept {
+        // the index is only cast once it's known to be in range, a clock stepping back gives a negative
+        // duration which goes to the first bucket
+        size_t index = Buckets;
+
+        if(!(value > Time_t{})) index = 0;
+        else if(bucketWidth > Time_t{} && value / bucketWidth < static_cast<Time_t>(Buckets)) index = static_cast<size_t>(value / bucketWidth);
+
+        buckets[index]++;
+        samples++;
+
+        if(maxValue < value) maxValue = value;
+    }
+
+    inline size_t getBucket(size_t index) const noexcept {
+        return index <= Buckets ? buckets[index] : 0;
+    }
+
+    inline constexpr size_t bucketCount() const noexcept {
+        return Buckets + 1;
+    }
+
+    inline Time_t getBucketWidth() const noexcept {
+        return bucketWidth;
+    }
+
+    inline void setBucketWidth(const Time_t& width) noexcept {
+        bucketWidth = width;
+        reset();
+    }
+
+    inline size_t getSamples() const noexcept {
+        return samples;
+    }
+
+    inline Time_t getMax() const noexcept {
+        return maxValue;
+    }
+
+    void reset() noexcept {
+        for(size_t i = 0; i <= Buckets; i++) buckets[i] = 0;
+        samples = 0;
+        maxValue = Time_t{};
+    }
+};
+
+enum class LoopStage : size_t {
+    timeRead = 0,
+    yawRead,
+    pid,
+    speedCalculation,
+    setSpeeds,
+    total
+};
+
+constexpr size_t loopStageCount = 6;
+
+// does nothing and reads no clock, so a platform using it carries no instrumentation cost
+struct NullLoopProfiler {
+    template <typename Clock_t> inline void begin(Clock_t&) noexcept {}
+    template <typename Clock_t> inline void mark(LoopStage, Clock_t&) noexcept {}
+    template <typename Clock_t> inline void end(Clock_t&) noexcept {}
+};
+
+// A default constructed profiler sizes its buckets from the first loop period it sees, they then span twice
+// that period, and the calibrating tick isn't recorded. The deadline stays off until it's set.
+template <typename Time_t, size_t Buckets = VISLIB_ROBO_PROFILER_BUCKETS> class LoopProfiler {
+protected:
+    LatencyHistogram<Time_t, Buckets> stages[loopStageCount]{};
+    LatencyHistogram<Time_t, Buckets> intervals{};
+
+    Time_t deadline{};
+    Time_t tickStart{};
+    Time_t lastMark{};
+    bool hasTick = false;
+
+    size_t overruns = 0;
+    size_t lateTicks = 0;
+
+public:
+
+    LoopProfiler() = default;
+
+    LoopProfiler(const Time_t& bucketWidth, const Time_t& deadline) noexcept : deadline(deadline) {
+        setBucketWidth(bucketWidth);
+    }
+
+    // reads the clock itself, so the first mark measures the tick's own time read
+    template <typename Clock_t> inline void begin(Clock_t& clock) noexcept {
+        const Time_t now = clock();
+
+        if(hasTick) {
+            const Time_t interval = now - tickStart;
+
+            if(!isConfigured() && interval > Time_t{}) {
+                Time_t width = interval * static_cast<Time_t>(2) / static_cast<Time_t>(Buckets);
+                if(!(width > Time_t{})) width = static_cast<Time_t>(1);
+
+                setBucketWidth(width);
+            }
+
+            intervals.record(interval);
+
+            if(deadline > Time_t{} && deadline < interval) lateTicks++;
+        }
+
+        tickStart = now;
+        lastMark = now;
+        hasTick = true;
+    }
+
+    template <typename Clock_t> inline void mark(LoopStage stage, Clock_t& clock) noexcept {
+        const Time_t now = clock();
+        stages[static_cast<size_t>(stage)].record(now - lastMark);
+        lastMark = now;
+    }
+
+    template <typename Clock_t> inline void end(Clock_t& clock) noexcept {
+        const Time_t duration = clock() - tickStart;
+        stages[static_cast<size_t>(LoopStage::total)].record(duration);
+
+        if(deadline > Time_t{} && deadline < duration) overruns++;
+    }
+
+    void setBucketWidth(const Time_t& width) noexcept {
+        for(size_t i = 0; i < loopStageCount; i++) stages[i].setBucketWidth(width);
+        intervals.setBucketWidth(width);
+    }
+
+    inline void setDeadline(const Time_t& deadline) noexcept {
+        this->deadline = deadline;
+    }
+
+    inline Time_t getDeadline() const noexcept {
+        return deadline;
+    }
+
+    // false until a bucket width is set or calibrated from the first loop period
+    inline bool isConfigured() const noexcept {
+        return intervals.getBucketWidth() > Time_t{};
+    }
+
+    inline const LatencyHistogram<Time_t, Buckets>& getStage(LoopStage stage) const noexcept {
+        return stages[static_cast<size_t>(stage)];
+    }
+
+    inline const LatencyHistogram<Time_t, Buckets>& getIntervals() const noexcept {
+        return intervals;
+    }
+
+    inline size_t getOverruns() const noexcept {
+        return overruns;
+    }
+
+    inline size_t getLateTicks() const noexcept {
+        return lateTicks;
+    }
+
+    void reset() noexcept {
+        for(size_t i = 0; i < loopStageCount; i++) stages[i].reset();
+        intervals.reset();
+        overruns = 0;
+        lateTicks = 0;
+        hasTick = false;
+    }
+};
+
+// begins a tick on construction and ends it on destruction, so ticks returning early on an error are recorded too
+template <typename Profiler_t, typename Clock_t> class LoopTickGuard {
+protected:
+    Profiler_t& profiler;
+    Clock_t& clock;
+
+public:
+
+    LoopTickGuard(Profiler_t& profiler, Clock_t& clock) noexcept : profiler(profiler), clock(clock) {
+        profiler.begin(clock);
+    }
+
+    LoopTickGuard(const LoopTickGuard&) = delete;
+    LoopTickGuard& operator=(const LoopTickGuard&) = delete;
+
+    ~LoopTickGuard() {
+        profiler.end(clock);
+    }
+};
+
+#ifdef VISLIB_ROBO_LOOP_PROFILING
+template <typename Time_t> using DefaultLoopProfiler = LoopProfiler<Time_t>;
+#else
+template <typename Time_t> using DefaultLoopProfiler = NullLoopProfiler;
+#endif
+
+} //vislib::platform
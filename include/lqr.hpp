@@ -0,0 +1,263 @@
+#pragma once
+
+#include <vislib.hpp>
+
+#include "matrix.hpp"
+#include "gyro.hpp"
+#include "platform.hpp"
+
+namespace vislib {
+
+// x[k + 1] = A x[k] + B u[k]
+template <typename T, size_t NX, size_t NU> struct LinearModel {
+    linear::Matrix<T, NX, NX> A{};
+    linear::Matrix<T, NX, NU> B{};
+};
+
+// Discrete algebraic Riccati equation by fixed point iteration:
+// K = (R + B'PB)^-1 B'PA, P = Q + A'P(A - BK). Meant for init or the host, the result is the gain for u = -K x.
+template <typename T, size_t NX, size_t NU> [[nodiscard]] core::Result<linear::Matrix<T, NU, NX>> solveDiscreteLqr(
+    const LinearModel<T, NX, NU>& model,
+    const linear::Matrix<T, NX, NX>& Q,
+    const linear::Matrix<T, NU, NU>& R,
+    size_t maxIterations = 1000,
+    const T& tolerance = T(1e-9)) noexcept {
+
+    const linear::Matrix<T, NX, NX> At = model.A.transposed();
+    const linear::Matrix<T, NU, NX> Bt = model.B.transposed();
+
+    linear::Matrix<T, NX, NX> P = Q;
+    linear::Matrix<T, NU, NX> K{};
+
+    for(size_t i = 0; i < maxIterations; i++) {
+        const linear::Matrix<T, NU, NX> BtP = Bt * P;
+
+        core::Result<linear::Matrix<T, NU, NU>> inv = linear::inverse(R + BtP * model.B);
+        if(inv) return inv.error();
+
+        K = inv() * (BtP * model.A);
+
+        const linear::Matrix<T, NX, NX> next = Q + At * P * (model.A - model.B * K);
+        const T change = linear::maxAbsDifference(next, P);
+
+        P = next;
+
+        if(change < tolerance) return K;
+    }
+
+    return core::Error(core::ErrorCode::invalidConfiguration, "The Riccati iteration didn't converge, the model may be uncontrollable");
+}
+
+// Per tick cost is one NU x NX matrix-vector product, outputs are clamped to the optional limits.
+template <typename T, size_t NX, size_t NU> class LQRController {
+protected:
+    linear::Matrix<T, NU, NX> K{};
+    T outputMin[NU]{};
+    T outputMax[NU]{};
+    bool isLimited = false;
+
+public:
+
+    LQRController() = default;
+
+    LQRController(const linear::Matrix<T, NU, NX>& gain) noexcept : K(gain) {}
+
+    inline void setGain(const linear::Matrix<T, NU, NX>& gain) noexcept {
+        K = gain;
+    }
+
+    inline const linear::Matrix<T, NU, NX>& getGain() const noexcept {
+        return K;
+    }
+
+    void setOutputLimits(const T (&min)[NU], const T (&max)[NU]) noexcept {
+        for(size_t i = 0; i < NU; i++) {
+            outputMin[i] = min[i];
+            outputMax[i] = max[i];
+        }
+
+        isLimited = true;
+    }
+
+    // u = -K (x - reference)
+    void compute(const T (&state)[NX], const T (&reference)[NX], T (&output)[NU]) const noexcept(core::numberNoexcept<T>()) {
+        T error[NX];
+        for(size_t j = 0; j < NX; j++) error[j] = state[j] - reference[j];
+
+        for(size_t i = 0; i < NU; i++) {
+            T u{};
+            for(size_t j = 0; j < NX; j++) u -= K[i][j] * error[j];
+
+            if(isLimited) {
+                if(outputMax[i] < u) u = outputMax[i];
+                if(u < outputMin[i]) u = outputMin[i];
+            }
+
+            output[i] = u;
+        }
+    }
+};
+
+namespace platform::calculators {
+
+// State [heading in degrees, platform angular speed in degrees per time unit], the unit gyro rates come in.
+// The input is the angular speed handed to calculatePlatformSpeeds in radians per time unit, which the motors
+// reach with a first order lag.
+template <typename T = double> LinearModel<T, 2, 1> headingModel(const T& dt, const T& motorTimeConstant) noexcept {
+    const T k = motorTimeConstant > T{} ? dt / motorTimeConstant : T(1);
+
+    LinearModel<T, 2, 1> model;
+    model.A[0][0] = 1;
+    model.A[0][1] = dt;
+    model.A[1][1] = k < 1 ? 1 - k : 0;
+    model.B[1][0] = static_cast<T>(core::rad2Deg(k < 1 ? k : 1));
+
+    return model;
+}
+
+// LQR counterpart of GyroPidCalculator, usable as the heading calculator of BasicGyroPlatform. Only heading is
+// under state feedback, translation stays the open loop speed command go() is given.
+// The angular speed state is the measured yaw rate when a rate source is set, BasicGyroPlatform reads it every
+// tick, so disturbances enter the state. Without one it is predicted from the previous correction through the
+// same first order model, which only sees disturbances once they have moved the heading.
+template <typename TimeType> class GyroLqrCalculator {
+public:
+    LQRController<double, 2, 1> lqr;
+    PlatformMotorConfig config;
+    double motorTimeConstant = 0;
+
+protected:
+    const gyro::AngularSpeedGetter<double>* rateSource = nullptr;
+    double estimatedAngularSpeed = 0;
+    double lastCorrection = 0;
+    double lastError = 0;
+    TimeType prevTime{};
+    bool hasTime = false;
+
+    // angular speed in degrees per time unit, the unit of the model state
+    double correctionFromState(TimeType time, const core::Angle<>& absCurrentAngle, const core::Angle<>& absMaintainAngle, double angularSpeed) noexcept {
+        lastError = -gyro::shortestAngleDifference(absCurrentAngle.deg(), absMaintainAngle.deg());
+
+        const double state[2] = {lastError, angularSpeed};
+        const double reference[2] = {0, 0};
+        double output[1];
+
+        lqr.compute(state, reference, output);
+
+        estimatedAngularSpeed = angularSpeed;
+        lastCorrection = output[0];
+        prevTime = time;
+        hasTime = true;
+
+        return output[0];
+    }
+
+public:
+
+    GyroLqrCalculator() = default;
+
+    GyroLqrCalculator(const LQRController<double, 2, 1>& lqr, const PlatformMotorConfig& config, double motorTimeConstant = 0,
+        const gyro::AngularSpeedGetter<double>* rateSource = nullptr) noexcept
+    : lqr(lqr), config(config), motorTimeConstant(motorTimeConstant), rateSource(rateSource) {}
+
+    // the yaw rate is the first axis of the source's angular speed, in degrees per time unit
+    inline void setRateSource(const gyro::AngularSpeedGetter<double>* source) noexcept {
+        rateSource = source;
+    }
+
+    inline const gyro::AngularSpeedGetter<double>* getRateSource() const noexcept {
+        return rateSource;
+    }
+
+    // yawRate is the gyro yaw rate in degrees per time unit, as AngularSpeedGetter reports it
+    double computeCorrection(TimeType time, const core::Angle<>& absCurrentAngle, const core::Angle<>& absMaintainAngle, double yawRate) noexcept {
+        return correctionFromState(time, absCurrentAngle, absMaintainAngle, yawRate);
+    }
+
+    // predicted angular speed state, used when there is no rate measurement
+    double computeCorrection(TimeType time, const core::Angle<>& absCurrentAngle, const core::Angle<>& absMaintainAngle) noexcept {
+        if(hasTime) {
+            const double dt = static_cast<double>(time - prevTime);
+            const double k = motorTimeConstant > 0 ? core::minF(dt / motorTimeConstant, 1.0) : 1.0;
+            estimatedAngularSpeed += (core::rad2Deg(lastCorrection) - estimatedAngularSpeed) * k;
+        }
+
+        return correctionFromState(time, absCurrentAngle, absMaintainAngle, estimatedAngularSpeed);
+    }
+
+    // measured angular speed state read from the rate source, falls back to the prediction without one
+    [[nodiscard]] core::Result<double> computeMeasuredCorrection(TimeType time, const core::Angle<>& absCurrentAngle, const core::Angle<>& absMaintainAngle) noexcept {
+        if(rateSource == nullptr) return computeCorrection(time, absCurrentAngle, absMaintainAngle);
+
+        core::Result<gyro::AngularSpeed<double>> rate = rateSource->getAngularSpeed();
+        if(rate) return rate.error();
+
+        if(rate().Size() == 0) return core::Error(core::ErrorCode::invalidResource, "The rate source returned no yaw rate");
+
+        return computeCorrection(time, absCurrentAngle, absMaintainAngle, rate()[0]);
+    }
+
+    // heading error of the last correction in degrees
+    inline double getError() const noexcept {
+        return lastError;
+    }
+
+    // angular speed state of the last correction in degrees per time unit
+    inline double getAngularSpeed() const noexcept {
+        return estimatedAngularSpeed;
+    }
+
+    inline double getCorrection() const noexcept {
+        return lastCorrection;
+    }
+
+    core::Result<PlatformMotorSpeeds> calculateSpeeds(
+        TimeType time,
+        const core::Angle<>& relTargetAngle,
+        const core::Angle<>& absCurrentAngle,
+        const core::Angle<>& absMaintainAngle,
+        const motor::Speed& speed,
+        const double angularSpeed = 0,
+        const double speedK = 1
+    ) noexcept {
+
+        return calculatePlatformSpeeds(config, relTargetAngle.deg(), speed, speedK, angularSpeed + computeCorrection(time, absCurrentAngle, absMaintainAngle));
+    }
+
+    void reset() noexcept {
+        estimatedAngularSpeed = 0;
+        lastCorrection = 0;
+        lastError = 0;
+        hasTime = false;
+    }
+};
+
+// solves the heading LQR for the loop period and motor lag, qHeading weights degrees of error, qRate degrees per
+// time unit of angular speed and r the radians per time unit of input
+template <typename TimeType> [[nodiscard]] core::Result<GyroLqrCalculator<TimeType>> makeGyroLqrCalculator(
+    const PlatformMotorConfig& config,
+    double dt,
+    double motorTimeConstant,
+    double qHeading = 1,
+    double qRate = 0,
+    double r = 1,
+    const gyro::AngularSpeedGetter<double>* rateSource = nullptr) noexcept {
+
+    if(!(dt > 0) || !(r > 0)) return core::Error(core::ErrorCode::invalidArgument, "The LQR period and input weight must be positive");
+
+    linear::Matrix<double, 2, 2> Q;
+    Q[0][0] = qHeading;
+    Q[1][1] = qRate;
+
+    linear::Matrix<double, 1, 1> R;
+    R[0][0] = r;
+
+    core::Result<linear::Matrix<double, 1, 2>> K = solveDiscreteLqr(headingModel(dt, motorTimeConstant), Q, R);
+    if(K) return K.error();
+
+    return GyroLqrCalculator<TimeType>(LQRController<double, 2, 1>(K()), config, motorTimeConstant, rateSource);
+}
+
+} // namespace vislib::platform::calculators
+
+} // namespace vislib
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <math.h>
+
+namespace vislib::linear {
+
+// fixed size row-major matrix, small enough to live on the stack of a control loop
+template <typename T, size_t Rows, size_t Cols> struct Matrix {
+    T data[Rows][Cols]{};
+
+    inline T* operator[](size_t row) noexcept {
+        return data[row];
+    }
+
+    inline const T* operator[](size_t row) const noexcept {
+        return data[row];
+    }
+
+    static Matrix identity() noexcept {
+        static_assert(Rows == Cols, "Identity matrix must be square");
+
+        Matrix result;
+        for(size_t i = 0; i < Rows; i++) result[i][i] = T(1);
+
+        return result;
+    }
+
+    Matrix<T, Cols, Rows> transposed() const noexcept {
+        Matrix<T, Cols, Rows> result;
+
+        for(size_t r = 0; r < Rows; r++) {
+            for(size_t c = 0; c < Cols; c++) result[c][r] = data[r][c];
+        }
+
+        return result;
+    }
+};
+
+template <typename T, size_t Rows, size_t Inner, size_t Cols> Matrix<T, Rows, Cols> operator*(const Matrix<T, Rows, Inner>& a, const Matrix<T, Inner, Cols>& b) noexcept {
+    Matrix<T, Rows, Cols> result;
+
+    for(size_t r = 0; r < Rows; r++) {
+        for(size_t k = 0; k < Inner; k++) {
+            const T v = a[r][k];
+            for(size_t c = 0; c < Cols; c++) result[r][c] += v * b[k][c];
+        }
+    }
+
+    return result;
+}
+
+template <typename T, size_t Rows, size_t Cols> Matrix<T, Rows, Cols> operator+(Matrix<T, Rows, Cols> a, const Matrix<T, Rows, Cols>& b) noexcept {
+    for(size_t r = 0; r < Rows; r++) {
+        for(size_t c = 0; c < Cols; c++) a[r][c] += b[r][c];
+    }
+
+    return a;
+}
+
+template <typename T, size_t Rows, size_t Cols> Matrix<T, Rows, Cols> operator-(Matrix<T, Rows, Cols> a, const Matrix<T, Rows, Cols>& b) noexcept {
+    for(size_t r = 0; r < Rows; r++) {
+        for(size_t c = 0; c < Cols; c++) a[r][c] -= b[r][c];
+    }
+
+    return a;
+}
+
+// Gauss-Jordan elimination with partial pivoting, meant for the few small solves done at init
+template <typename T, size_t N> [[nodiscard]] core::Result<Matrix<T, N, N>> inverse(Matrix<T, N, N> m) noexcept {
+    Matrix<T, N, N> result = Matrix<T, N, N>::identity();
+
+    for(size_t col = 0; col < N; col++) {
+        size_t pivot = col;
+
+        for(size_t row = col + 1; row < N; row++) {
+            if(core::absF(m[row][col]) > core::absF(m[pivot][col])) pivot = row;
+        }
+
+        if(core::absF(m[pivot][col]) < T(1e-12)) return core::Error(core::ErrorCode::invalidArgument, "The matrix is singular");
+
+        if(pivot != col) {
+            for(size_t k = 0; k < N; k++) {
+                T t = m[col][k];
+                m[col][k] = m[pivot][k];
+                m[pivot][k] = t;
+
+                t = result[col][k];
+                result[col][k] = result[pivot][k];
+                result[pivot][k] = t;
+            }
+        }
+
+        const T scale = m[col][col];
+
+        for(size_t k = 0; k < N; k++) {
+            m[col][k] /= scale;
+            result[col][k] /= scale;
+        }
+
+        for(size_t row = 0; row < N; row++) {
+            if(row == col) continue;
+
+            const T f = m[row][col];
+            if(f == T{}) continue;
+
+            for(size_t k = 0; k < N; k++) {
+                m[row][k] -= f * m[col][k];
+                result[row][k] -= f * result[col][k];
+            }
+        }
+    }
+
+    return result;
+}
+
+// in place Cholesky factorization m = L L', only the lower triangle is written and read afterwards
+template <typename T, size_t N> [[nodiscard]] core::Error choleskyFactor(Matrix<T, N, N>& m) noexcept {
+    for(size_t j = 0; j < N; j++) {
+        T diagonal = m[j][j];
+        for(size_t k = 0; k < j; k++) diagonal -= m[j][k] * m[j][k];
+
+        if(!(diagonal > T{})) return {core::ErrorCode::invalidArgument, "The matrix isn't positive definite"};
+
+        m[j][j] = static_cast<T>(sqrt(diagonal));
+
+        for(size_t i = j + 1; i < N; i++) {
+            T value = m[i][j];
+            for(size_t k = 0; k < j; k++) value -= m[i][k] * m[j][k];
+            m[i][j] = value / m[j][j];
+        }
+    }
+
+    return {};
+}
+
+// solves L L' x = b in place using the factor produced by choleskyFactor
+template <typename T, size_t N> void choleskySolve(const Matrix<T, N, N>& factor, T (&b)[N]) noexcept {
+    for(size_t i = 0; i < N; i++) {
+        T value = b[i];
+        for(size_t k = 0; k < i; k++) value -= factor[i][k] * b[k];
+        b[i] = value / factor[i][i];
+    }
+
+    for(size_t i = N; i-- > 0;) {
+        T value = b[i];
+        for(size_t k = i + 1; k < N; k++) value -= factor[k][i] * b[k];
+        b[i] = value / factor[i][i];
+    }
+}
+
+template <typename T, size_t Rows, size_t Cols> T maxAbsDifference(const Matrix<T, Rows, Cols>& a, const Matrix<T, Rows, Cols>& b) noexcept {
+    T result{};
+
+    for(size_t r = 0; r < Rows; r++) {
+        for(size_t c = 0; c < Cols; c++) {
+            const T d = core::absF(a[r][c] - b[r][c]);
+            if(result < d) result = d;
+        }
+    }
+
+    return result;
+}
+
+} // namespace vislib::linear
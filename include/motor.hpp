@@ -1,7 +1,11 @@
 #pragma once
 
 #include <vislib.hpp>
+#if __has_include("Arduino.h")
 #include "Arduino.h"
+#else
+#include <math.h>
+#endif
 
 namespace vislib::motor {
 
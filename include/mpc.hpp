@@ -0,0 +1,314 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <math.h>
+
+#include "matrix.hpp"
+#include "platform.hpp"
+
+namespace vislib::platform {
+
+// body velocity of the platform: vx, vy along the motor angle 0 and 90 degree axes,
+// angularSpeed in the units calculatePlatformSpeeds takes
+struct VelocityCommand {
+    double vx = 0;
+    double vy = 0;
+    double angularSpeed = 0;
+};
+
+struct VelocityMpcConfig {
+    double dt = 0.01;
+    double motorTimeConstant = 0.05;
+    double linearWeight = 1;
+    double angularWeight = 1;
+    double rateWeight = 0.05;
+    double effortWeight = 1e-4;
+    double rho = 0.1;
+    double sigma = 1e-6;
+    size_t iterations = 25;
+};
+
+namespace calculators {
+
+inline double rangeMin(const motor::SpeedRange& range) noexcept {
+    return range.restrict(-1e30);
+}
+
+inline double rangeMax(const motor::SpeedRange& range) noexcept {
+    return range.restrict(1e30);
+}
+
+// row of the platform kinematics: interface speed of the motor produced by a body velocity, the same mapping
+// calculatePlatformSpeeds uses with vx = speed * cos(angle) and vy = speed * sin(angle)
+inline void motorKinematicsRow(const motor::MotorInfo& info, double (&row)[3]) noexcept {
+    const double parallel = info.parallelAxisesAmount != 0 ? static_cast<double>(info.parallelAxisesAmount) : 1;
+    const double wheelR = info.wheelR != 0 ? info.wheelR : 1;
+    const double angle = info.anglePos * 3.14159265358979323846 / 180;
+
+    row[0] = cos(angle) / parallel / wheelR;
+    row[1] = sin(angle) / parallel / wheelR;
+    row[2] = info.distance / wheelR;
+}
+
+} // namespace vislib::platform::calculators
+
+// Fixed horizon MPC over the body velocity. Each axis follows the command with the first order motor lag,
+// the cost tracks the reference velocity and penalizes command changes, and every predicted command must keep
+// all motors inside their interfaceSpeedRange. The condensed QP is solved by ADMM: the KKT matrix is constant,
+// so it is Cholesky factored once in configure() and every tick runs a fixed number of iterations of
+// triangular solves and clamps, which bounds the worst case time. Iterates are warm started from the previous
+// tick shifted by one step. All storage is inside the object, nothing is allocated.
+template <size_t Horizon, size_t MaxMotors> class VelocityMpc {
+    static_assert(Horizon > 0 && MaxMotors > 0, "MPC needs a horizon and at least one motor");
+
+protected:
+    static constexpr size_t N = 3 * Horizon;
+
+    VelocityMpcConfig config{};
+    size_t motors = 0;
+    double rows[MaxMotors][3]{};
+    double lower[MaxMotors]{};
+    double upper[MaxMotors]{};
+    double scales[MaxMotors]{};
+
+    // prediction: v[k + 1] = decay^(k + 1) v0 + sum over j <= k of gain[k - j] u[j]
+    double decay = 0;
+    double gain[Horizon]{};
+
+    linear::Matrix<double, N, N> factor{};
+
+    double x[N]{};
+    double z[Horizon][MaxMotors]{};
+    double y[Horizon][MaxMotors]{};
+
+    VelocityCommand lastCommand{};
+    double primalResidual = 0;
+    bool isConfigured = false;
+
+    inline double axisWeight(size_t axis) const noexcept {
+        return axis == 2 ? config.angularWeight : config.linearWeight;
+    }
+
+    void shiftWarmStart() noexcept {
+        for(size_t k = 0; k + 1 < Horizon; k++) {
+            for(size_t a = 0; a < 3; a++) x[k * 3 + a] = x[(k + 1) * 3 + a];
+
+            for(size_t i = 0; i < motors; i++) {
+                z[k][i] = z[k + 1][i];
+                y[k][i] = y[k + 1][i];
+            }
+        }
+    }
+
+public:
+
+    VelocityMpc() = default;
+
+    [[nodiscard]] core::Error configure(const PlatformMotorConfig& motorConfig, const VelocityMpcConfig& mpcConfig) noexcept {
+        isConfigured = false;
+
+        if(motorConfig.Size() == 0 || motorConfig.Size() > MaxMotors) {
+            return {core::ErrorCode::invalidArgument, "The MPC motor capacity doesn't fit the motor config"};
+        }
+
+        if(!(mpcConfig.dt > 0) || !(mpcConfig.rho > 0) || mpcConfig.sigma < 0 || mpcConfig.iterations == 0) {
+            return {core::ErrorCode::invalidConfiguration, "The MPC period, ADMM step and iteration budget must be positive"};
+        }
+
+        config = mpcConfig;
+        motors = motorConfig.Size();
+
+        // constraint rows are scaled to unit length, which keeps rho meaningful whatever the wheel sizes are
+        for(size_t i = 0; i < motors; i++) {
+            calculators::motorKinematicsRow(motorConfig[i], rows[i]);
+
+            const double norm = sqrt(rows[i][0] * rows[i][0] + rows[i][1] * rows[i][1] + rows[i][2] * rows[i][2]);
+            if(!(norm > 0)) return {core::ErrorCode::invalidConfiguration, "A motor in the config doesn't move the platform"};
+
+            for(size_t a = 0; a < 3; a++) rows[i][a] /= norm;
+
+            scales[i] = norm;
+            lower[i] = calculators::rangeMin(motorConfig[i].interfaceSpeedRange) / norm;
+            upper[i] = calculators::rangeMax(motorConfig[i].interfaceSpeedRange) / norm;
+        }
+
+        decay = config.motorTimeConstant > 0 ? exp(-config.dt / config.motorTimeConstant) : 0;
+
+        for(size_t d = 0; d < Horizon; d++) gain[d] = pow(decay, static_cast<double>(d)) * (1 - decay);
+
+        // the KKT matrix is built in place of its factor, so configure() needs no large stack buffers
+        linear::Matrix<double, N, N>& kkt = factor;
+        kkt = linear::Matrix<double, N, N>{};
+
+        for(size_t j = 0; j < Horizon; j++) {
+            // P = W G'G + S D'D + E I for every axis, D being the command difference operator
+            for(size_t l = 0; l < Horizon; l++) {
+                double gtg = 0;
+                for(size_t k = (j > l ? j : l); k < Horizon; k++) gtg += gain[k - j] * gain[k - l];
+
+                double smooth = 0;
+                if(j == l) smooth = j + 1 < Horizon ? 2 : 1;
+                else if(j == l + 1 || l == j + 1) smooth = -1;
+
+                for(size_t a = 0; a < 3; a++) {
+                    kkt[j * 3 + a][l * 3 + a] = axisWeight(a) * gtg + config.rateWeight * smooth + (j == l ? config.effortWeight : 0);
+                }
+            }
+
+            // rho C'C, the motor constraints only couple the axes of the same step
+            for(size_t a = 0; a < 3; a++) {
+                for(size_t b = 0; b < 3; b++) {
+                    double ctc = 0;
+                    for(size_t i = 0; i < motors; i++) ctc += rows[i][a] * rows[i][b];
+
+                    kkt[j * 3 + a][j * 3 + b] += config.rho * ctc;
+                }
+
+                kkt[j * 3 + a][j * 3 + a] += config.sigma;
+            }
+        }
+
+        core::Error err = linear::choleskyFactor(kkt);
+        if(err) return err;
+
+        reset();
+        isConfigured = true;
+
+        return {};
+    }
+
+    [[nodiscard]] core::Result<VelocityCommand> solve(const VelocityCommand& current, const VelocityCommand& reference) noexcept {
+        if(!isConfigured) return core::Error(core::ErrorCode::invalidConfiguration, "The MPC isn't configured");
+
+        const double v0[3] = {current.vx, current.vy, current.angularSpeed};
+        const double ref[3] = {reference.vx, reference.vy, reference.angularSpeed};
+        const double previous[3] = {lastCommand.vx, lastCommand.vy, lastCommand.angularSpeed};
+
+        // q = W G'(free response - reference) - S u_prev on the first step
+        double q[N];
+
+        for(size_t j = 0; j < Horizon; j++) {
+            for(size_t a = 0; a < 3; a++) {
+                double value = 0;
+                double freeResponse = v0[a];
+
+                for(size_t k = 0; k < Horizon; k++) {
+                    freeResponse *= decay;
+                    if(k >= j) value += gain[k - j] * (freeResponse - ref[a]);
+                }
+
+                q[j * 3 + a] = axisWeight(a) * value - (j == 0 ? config.rateWeight * previous[a] : 0);
+            }
+        }
+
+        shiftWarmStart();
+
+        for(size_t iteration = 0; iteration < config.iterations; iteration++) {
+            double rhs[N];
+
+            for(size_t j = 0; j < Horizon; j++) {
+                for(size_t a = 0; a < 3; a++) {
+                    double value = config.sigma * x[j * 3 + a] - q[j * 3 + a];
+                    for(size_t i = 0; i < motors; i++) value += rows[i][a] * (config.rho * z[j][i] - y[j][i]);
+
+                    rhs[j * 3 + a] = value;
+                }
+            }
+
+            linear::choleskySolve(factor, rhs);
+
+            primalResidual = 0;
+
+            for(size_t j = 0; j < Horizon; j++) {
+                for(size_t a = 0; a < 3; a++) x[j * 3 + a] = rhs[j * 3 + a];
+
+                for(size_t i = 0; i < motors; i++) {
+                    const double cx = rows[i][0] * x[j * 3] + rows[i][1] * x[j * 3 + 1] + rows[i][2] * x[j * 3 + 2];
+
+                    double projected = cx + y[j][i] / config.rho;
+                    if(projected < lower[i]) projected = lower[i];
+                    if(upper[i] < projected) projected = upper[i];
+
+                    z[j][i] = projected;
+                    y[j][i] += config.rho * (cx - projected);
+
+                    if(primalResidual < core::absF(cx - projected)) primalResidual = core::absF(cx - projected);
+                }
+            }
+        }
+
+        // the iteration budget may stop ADMM slightly outside the limits, scaling the applied command
+        // down keeps its direction and brings every motor back into its range
+        double scale = 1;
+
+        for(size_t i = 0; i < motors; i++) {
+            const double cx = rows[i][0] * x[0] + rows[i][1] * x[1] + rows[i][2] * x[2];
+
+            if(upper[i] < cx && upper[i] > 0) scale = core::minF(scale, upper[i] / cx);
+            if(cx < lower[i] && lower[i] < 0) scale = core::minF(scale, lower[i] / cx);
+        }
+
+        lastCommand.vx = x[0] * scale;
+        lastCommand.vy = x[1] * scale;
+        lastCommand.angularSpeed = x[2] * scale;
+
+        return lastCommand;
+    }
+
+    // interface speeds for the motors
+    [[nodiscard]] core::Result<PlatformMotorSpeeds> toMotorSpeeds(const VelocityCommand& command) const noexcept {
+        if(!isConfigured) return core::Error(core::ErrorCode::invalidConfiguration, "The MPC isn't configured");
+
+        PlatformMotorSpeeds speeds(motors);
+
+        for(size_t i = 0; i < motors; i++) {
+            speeds[i] = (rows[i][0] * command.vx + rows[i][1] * command.vy + rows[i][2] * command.angularSpeed) * scales[i];
+        }
+
+        return speeds;
+    }
+
+    template <typename Controller_t> [[nodiscard]] core::Error apply(Platform<Controller_t>& platform, const VelocityCommand& current, const VelocityCommand& reference) noexcept {
+        core::Result<VelocityCommand> command = solve(current, reference);
+        if(command) return command.error();
+
+        core::Result<PlatformMotorSpeeds> speeds = toMotorSpeeds(command());
+        if(speeds) return speeds.error();
+
+        return platform.setSpeeds(speeds());
+    }
+
+    // velocity the model expects one period after the last command, usable as current when there is no odometry
+    VelocityCommand predictNext(const VelocityCommand& current) const noexcept {
+        VelocityCommand next;
+        next.vx = decay * current.vx + (1 - decay) * lastCommand.vx;
+        next.vy = decay * current.vy + (1 - decay) * lastCommand.vy;
+        next.angularSpeed = decay * current.angularSpeed + (1 - decay) * lastCommand.angularSpeed;
+
+        return next;
+    }
+
+    inline double getPrimalResidual() const noexcept {
+        return primalResidual;
+    }
+
+    inline const VelocityCommand& getLastCommand() const noexcept {
+        return lastCommand;
+    }
+
+    void reset() noexcept {
+        for(size_t i = 0; i < N; i++) x[i] = 0;
+
+        for(size_t k = 0; k < Horizon; k++) {
+            for(size_t i = 0; i < MaxMotors; i++) {
+                z[k][i] = 0;
+                y[k][i] = 0;
+            }
+        }
+
+        lastCommand = VelocityCommand{};
+        primalResidual = 0;
+    }
+};
+
+} // namespace vislib::platform
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <math.h>
+
+#include "gyro.hpp"
+
+namespace vislib::platform {
+
+// heading is the platform heading wanted at the point in degrees, it's independent of the travel direction
+struct PathPoint {
+    double x = 0;
+    double y = 0;
+    double heading = 0;
+};
+
+struct PurePursuitConfig {
+    double lookahead = 0.3;
+    double cruiseSpeed = 1;
+    double minSpeed = 0.05;
+    double slowdownDistance = 0.5;
+    double finishTolerance = 0.02;
+    // how many segments the closest point may advance per update
+    size_t searchWindow = 8;
+};
+
+// pathAngle is the direction towards the lookahead point in the path frame, for go() with isAngleRelative = true.
+// angle is the same direction already turned by the yaw the way go() does it, for isAngleRelative = false.
+// head is the path heading at the lookahead point for setHead(), angularSpeed the matching feed forward in the
+// units go() takes.
+struct PursuitCommand {
+    core::Angle<> angle{};
+    core::Angle<> pathAngle{};
+    double speed = 0;
+    core::Angle<> head{};
+    double angularSpeed = 0;
+    bool isFinished = false;
+};
+
+// Pure pursuit over a polyline. Cumulative lengths are computed once in setPath(), after that the closest segment
+// and the lookahead segment only move forward from where the previous update left them, so a tick costs O(1)
+// amortized instead of a scan over the whole path.
+class PurePursuitFollower {
+protected:
+    PurePursuitConfig config{};
+    core::Array<PathPoint> path;
+    core::Array<double> distances;
+
+    size_t closest = 0;
+    size_t lookaheadSegment = 0;
+    double progress = 0;
+
+    static inline double projectOnSegment(const PathPoint& a, const PathPoint& b, double x, double y, double& t) noexcept {
+        const double dx = b.x - a.x;
+        const double dy = b.y - a.y;
+        const double length2 = dx * dx + dy * dy;
+
+        t = length2 > 0 ? ((x - a.x) * dx + (y - a.y) * dy) / length2 : 0;
+        if(t < 0) t = 0;
+        if(t > 1) t = 1;
+
+        const double px = a.x + dx * t - x;
+        const double py = a.y + dy * t - y;
+
+        return px * px + py * py;
+    }
+
+    inline double segmentLength(size_t segment) const noexcept {
+        return distances[segment + 1] - distances[segment];
+    }
+
+    PathPoint pointAt(double distance) noexcept {
+        const size_t last = path.Size() - 1;
+
+        // clamped to the end the lookahead point lies on the last segment, the feed forward uses its turn
+        if(distance >= distances[last]) {
+            lookaheadSegment = last - 1;
+            return path[last];
+        }
+
+        if(lookaheadSegment < closest) lookaheadSegment = closest;
+        while(lookaheadSegment + 1 < last && distances[lookaheadSegment + 1] < distance) lookaheadSegment++;
+
+        const double length = segmentLength(lookaheadSegment);
+        const double t = length > 0 ? (distance - distances[lookaheadSegment]) / length : 0;
+
+        const PathPoint& a = path[lookaheadSegment];
+        const PathPoint& b = path[lookaheadSegment + 1];
+
+        PathPoint point;
+        point.x = a.x + (b.x - a.x) * t;
+        point.y = a.y + (b.y - a.y) * t;
+        point.heading = a.heading + gyro::shortestAngleDifference(a.heading, b.heading) * t;
+
+        return point;
+    }
+
+public:
+
+    PurePursuitFollower() = default;
+
+    PurePursuitFollower(const PurePursuitConfig& config) noexcept : config(config) {}
+
+    [[nodiscard]] core::Error setPath(const core::Array<PathPoint>& points) noexcept {
+        if(points.Size() < 2) return {core::ErrorCode::invalidArgument, "A path needs at least two points"};
+
+        path = points;
+        distances = core::Array<double>(points.Size());
+        distances[0] = 0;
+
+        for(size_t i = 1; i < points.Size(); i++) {
+            distances[i] = distances[i - 1] + hypot(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y);
+        }
+
+        reset();
+
+        return {};
+    }
+
+    inline void setConfig(const PurePursuitConfig& config) noexcept {
+        this->config = config;
+    }
+
+    inline const PurePursuitConfig& getConfig() const noexcept {
+        return config;
+    }
+
+    void reset() noexcept {
+        closest = 0;
+        lookaheadSegment = 0;
+        progress = 0;
+    }
+
+    // position in the path frame, yaw in degrees measured in the same frame
+    [[nodiscard]] core::Result<PursuitCommand> update(double x, double y, const core::Angle<>& yaw) noexcept {
+        if(path.Size() < 2) return core::Error(core::ErrorCode::invalidConfiguration, "The follower has no path");
+
+        const size_t segments = path.Size() - 1;
+
+        double t = 0;
+        double best = projectOnSegment(path[closest], path[closest + 1], x, y, t);
+        double bestT = t;
+
+        // the closest point only moves forward and stops at the first segment that gets farther away
+        for(size_t step = 0; step < config.searchWindow && closest + 1 < segments; step++) {
+            const double next = projectOnSegment(path[closest + 1], path[closest + 2], x, y, t);
+            if(next > best) break;
+
+            closest++;
+            best = next;
+            bestT = t;
+        }
+
+        const double traveled = distances[closest] + segmentLength(closest) * bestT;
+        if(traveled > progress) progress = traveled;
+
+        const double total = distances[segments];
+        const double remaining = total - progress;
+
+        PursuitCommand command;
+
+        const PathPoint target = pointAt(progress + config.lookahead);
+        const double dx = target.x - x;
+        const double dy = target.y - y;
+        const double targetDistance = hypot(dx, dy);
+
+        command.head = core::Angle<>(target.heading);
+
+        if(remaining <= config.finishTolerance && targetDistance <= config.finishTolerance) {
+            command.isFinished = true;
+            return command;
+        }
+
+        command.pathAngle = core::Angle<>(core::rad2Deg(atan2(dy, dx)));
+        command.angle = yaw - command.pathAngle;
+
+        double speed = config.cruiseSpeed;
+        const double toEnd = remaining > targetDistance ? remaining : targetDistance;
+
+        if(config.slowdownDistance > 0 && toEnd < config.slowdownDistance) speed = config.cruiseSpeed * toEnd / config.slowdownDistance;
+        if(speed < config.minSpeed) speed = config.minSpeed;
+
+        command.speed = speed;
+
+        // feed forward of the heading change along the path, degrees per distance times speed, in radians
+        const double length = segmentLength(lookaheadSegment);
+        if(length > 0) {
+            const double turn = gyro::shortestAngleDifference(path[lookaheadSegment].heading, path[lookaheadSegment + 1].heading);
+            command.angularSpeed = turn / length * speed * 3.14159265358979323846 / 180;
+        }
+
+        return command;
+    }
+
+    inline size_t getClosestIndex() const noexcept {
+        return closest;
+    }
+
+    inline double getProgress() const noexcept {
+        return progress;
+    }
+
+    inline double getLength() const noexcept {
+        return path.Size() > 0 ? distances[path.Size() - 1] : 0;
+    }
+};
+
+} // namespace vislib::platform
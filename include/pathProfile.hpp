@@ -0,0 +1,232 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <math.h>
+
+#include "gyro.hpp"
+#include "mpc.hpp"
+#include "splinePath.hpp"
+
+namespace vislib::platform {
+
+// maxWheelAcceleration is in interface speed units per time unit and maxLateralAcceleration in distance units
+// per time unit squared, zero leaves either of them unlimited
+struct PathProfileConfig {
+    double spacing = 0.01;
+    double maxSpeed = 1;
+    double maxAcceleration = 1;
+    double maxWheelAcceleration = 0;
+    double maxLateralAcceleration = 0;
+    double startSpeed = 0;
+    double endSpeed = 0;
+};
+
+// angularSpeed is the heading rate the path asks for at the speed, in the units go() takes
+struct PathProfileState {
+    double distance = 0;
+    double time = 0;
+    double speed = 0;
+    double acceleration = 0;
+    double angularSpeed = 0;
+};
+
+// Time parameterization of a path. Every sample gets the highest speed at which no wheel leaves its interface
+// speed range, given the travel direction relative to the platform and the heading rate there, optionally capped
+// by the lateral acceleration over the curvature. A forward pass then limits how fast speed may grow and a backward
+// pass how fast it may drop, with the acceleration allowed at each sample by maxAcceleration and the most loaded
+// wheel. Limits are enforced at the samples, between them the acceleration is constant, so a finer spacing follows
+// sharp changes of the wheel load more closely. Distance lookups are O(1) and time lookups O(log n).
+// The speed at the progress of a PurePursuitFollower can replace its constant cruise speed.
+class PathSpeedProfile {
+protected:
+    struct Sample {
+        double speed = 0;
+        double time = 0;
+        // heading change in radians per distance
+        double headingRate = 0;
+    };
+
+    core::Array<Sample> samples;
+    double step = 0;
+    double length = 0;
+
+    inline double segmentAcceleration(size_t i) const noexcept {
+        return step > 0 ? (samples[i + 1].speed * samples[i + 1].speed - samples[i].speed * samples[i].speed) / (2 * step) : 0;
+    }
+
+    PathProfileState stateInSegment(size_t i, double offset) const noexcept {
+        const double acceleration = segmentAcceleration(i);
+        const double start = samples[i].speed;
+
+        double speed = start * start + 2 * acceleration * offset;
+        speed = speed > 0 ? sqrt(speed) : 0;
+
+        PathProfileState state;
+        state.distance = i * step + offset;
+        state.time = samples[i].time + (start + speed > 0 ? 2 * offset / (start + speed) : 0);
+        state.speed = speed;
+        state.acceleration = acceleration;
+        state.angularSpeed = speed * samples[i + 1].headingRate;
+
+        return state;
+    }
+
+public:
+
+    PathSpeedProfile() = default;
+
+    // Path_t is sampled by distance through length() and sample(), as SplinePath provides
+    template <typename Path_t> [[nodiscard]] core::Error build(Path_t& path, const PlatformMotorConfig& motors, const PathProfileConfig& config) noexcept {
+        samples = core::Array<Sample>();
+        step = 0;
+        length = 0;
+
+        if(!(config.spacing > 0) || !(config.maxSpeed > 0) || !(config.maxAcceleration > 0)) {
+            return {core::ErrorCode::invalidConfiguration, "The profile spacing, speed and acceleration limits must be positive"};
+        }
+
+        if(motors.Size() == 0) return {core::ErrorCode::invalidArgument, "The profile needs at least one motor"};
+
+        const double total = path.length();
+        if(!(total > 0)) return {core::ErrorCode::invalidArgument, "The path has no length"};
+
+        // at least one sample between the ends, so a profile starting and ending at rest can move
+        size_t count = static_cast<size_t>(ceil(total / config.spacing)) + 1;
+        if(count < 3) count = 3;
+
+        const double ds = total / (count - 1);
+
+        core::Array<Sample> result(count);
+        core::Array<double> directions(count);
+        core::Array<double> limits(count);
+        core::Array<double> accelerations(count);
+
+        double previousHeading = 0;
+
+        for(size_t i = 0; i < count; i++) {
+            core::Result<SplineSample> point = path.sample(i * ds);
+            if(point) return point.error();
+
+            // each sample keeps the rate of the segment ending at it, the first one takes the rate after it
+            if(i > 0) result[i].headingRate = gyro::shortestAngleDifference(previousHeading, point().heading) / ds * 3.14159265358979323846 / 180;
+            previousHeading = point().heading;
+
+            // travel direction relative to the platform, the way go() turns an absolute direction with the yaw
+            directions[i] = point().heading - point().tangent;
+
+            limits[i] = config.maxSpeed;
+
+            if(config.maxLateralAcceleration > 0 && core::absF(point().curvature) > 0) {
+                limits[i] = core::minF(limits[i], sqrt(config.maxLateralAcceleration / core::absF(point().curvature)));
+            }
+        }
+
+        result[0].headingRate = result[1].headingRate;
+
+        for(size_t i = 0; i < count; i++) {
+            const double angle = directions[i] * 3.14159265358979323846 / 180;
+            accelerations[i] = config.maxAcceleration;
+
+            for(size_t m = 0; m < motors.Size(); m++) {
+                double row[3];
+                calculators::motorKinematicsRow(motors[m], row);
+
+                // wheel interface speed per unit of path speed
+                const double factor = row[0] * cos(angle) + row[1] * sin(angle) + row[2] * result[i].headingRate;
+
+                if(factor > 0) limits[i] = core::minF(limits[i], calculators::rangeMax(motors[m].interfaceSpeedRange) / factor);
+                if(factor < 0) limits[i] = core::minF(limits[i], calculators::rangeMin(motors[m].interfaceSpeedRange) / factor);
+
+                if(config.maxWheelAcceleration > 0 && factor != 0) {
+                    accelerations[i] = core::minF(accelerations[i], config.maxWheelAcceleration / core::absF(factor));
+                }
+            }
+
+            if(!(limits[i] > 0)) {
+                return {core::ErrorCode::invalidConfiguration, "The motor speed ranges don't allow moving along the path at sample " + core::to_string(static_cast<size_t>(i))};
+            }
+        }
+
+        limits[0] = core::minF(limits[0], config.startSpeed > 0 ? config.startSpeed : 0.0);
+        limits[count - 1] = core::minF(limits[count - 1], config.endSpeed > 0 ? config.endSpeed : 0.0);
+
+        result[0].speed = limits[0];
+
+        for(size_t i = 1; i < count; i++) {
+            result[i].speed = core::minF(limits[i], sqrt(result[i - 1].speed * result[i - 1].speed + 2 * accelerations[i - 1] * ds));
+        }
+
+        for(size_t i = count - 1; i > 0; i--) {
+            result[i - 1].speed = core::minF(result[i - 1].speed, sqrt(result[i].speed * result[i].speed + 2 * accelerations[i] * ds));
+        }
+
+        result[0].time = 0;
+
+        for(size_t i = 1; i < count; i++) {
+            const double speedSum = result[i - 1].speed + result[i].speed;
+            if(!(speedSum > 0)) return {core::ErrorCode::invalidConfiguration, "The profile stalls, the path can't be traveled with the given limits"};
+
+            result[i].time = result[i - 1].time + 2 * ds / speedSum;
+        }
+
+        samples = core::move(result);
+        step = ds;
+        length = total;
+
+        return {};
+    }
+
+    [[nodiscard]] core::Result<PathProfileState> atDistance(double distance) const noexcept {
+        if(samples.Size() < 2) return core::Error(core::ErrorCode::invalidConfiguration, "The profile isn't built");
+
+        if(distance < 0) distance = 0;
+        if(distance > length) distance = length;
+
+        size_t i = static_cast<size_t>(distance / step);
+        if(i > samples.Size() - 2) i = samples.Size() - 2;
+
+        return stateInSegment(i, distance - i * step);
+    }
+
+    [[nodiscard]] core::Result<PathProfileState> atTime(double time) const noexcept {
+        if(samples.Size() < 2) return core::Error(core::ErrorCode::invalidConfiguration, "The profile isn't built");
+
+        if(time < 0) time = 0;
+        if(time > getDuration()) time = getDuration();
+
+        size_t low = 0;
+        size_t high = samples.Size() - 1;
+
+        while(high - low > 1) {
+            const size_t middle = (low + high) / 2;
+
+            if(samples[middle].time <= time) low = middle;
+            else high = middle;
+        }
+
+        const double elapsed = time - samples[low].time;
+
+        double offset = samples[low].speed * elapsed + segmentAcceleration(low) * elapsed * elapsed / 2;
+        if(offset < 0) offset = 0;
+        if(offset > step) offset = step;
+
+        PathProfileState state = stateInSegment(low, offset);
+        state.time = time;
+
+        return state;
+    }
+
+    inline double getDuration() const noexcept {
+        return samples.Size() > 0 ? samples[samples.Size() - 1].time : 0;
+    }
+
+    inline double getLength() const noexcept {
+        return length;
+    }
+
+    inline size_t getSampleCount() const noexcept {
+        return samples.Size();
+    }
+};
+
+} // namespace vislib::platform
@@ -12,9 +12,14 @@ protected:
     T errold{};
     T integral{};
     T target{};
+    T derivative{};
+    T output{};
     TimeType prevTime{};
+    bool isIntegrationEnabled = true;
     
 public:
+    PIDRegulator() = default;
+    
     PIDRegulator(const T& Kp, const T& Ki, const T& Kd, const T& target = T{}) noexcept(core::numberNoexcept<T>()) : Kp(Kp), Ki(Ki), Kd(Kd), target(target) {}
 
     
@@ -24,17 +29,18 @@ public:
         if (prevTime == 0) {
             prevTime = time;
             errold = error;
-            return Kp * error;
+            output = Kp * error;
+            return output;
         }
         
         TimeType timeStep = time - prevTime;
         
         
-        integral += error * timeStep;
+        if(isIntegrationEnabled) integral += error * timeStep;
         
-        T derivative = (timeStep > 0) ? (error - errold) / static_cast<T>(timeStep) : 0;
+        derivative = (timeStep > 0) ? (error - errold) / static_cast<T>(timeStep) : 0;
         
-        T output = Kp * error + Ki * integral + Kd * derivative;
+        output = Kp * error + Ki * integral + Kd * derivative;
         
         errold = error;
         prevTime = time;
@@ -51,20 +57,218 @@ public:
         this->target = target;
     }
     
+    inline void setCoefficients(const T& Kp, const T& Ki, const T& Kd) noexcept(core::numberNoexcept<T>()) {
+        this->Kp = Kp;
+        this->Ki = Ki;
+        this->Kd = Kd;
+    }
+    
+    // while disabled the integral is frozen, used for conditional integration against windup
+    inline void setIntegration(bool isEnabled) noexcept {
+        isIntegrationEnabled = isEnabled;
+    }
+    
+    inline constexpr bool isIntegrating() const noexcept {
+        return isIntegrationEnabled;
+    }
+    
+    inline constexpr T getKp() const noexcept {
+        return Kp;
+    }
+    
+    inline constexpr T getKi() const noexcept {
+        return Ki;
+    }
+    
+    inline constexpr T getKd() const noexcept {
+        return Kd;
+    }
+    
     inline constexpr T getTarget() const noexcept {
         return target;
     }
     
+    inline constexpr T getError() const noexcept {
+        return errold;
+    }
+    
+    inline constexpr T getIntegral() const noexcept {
+        return integral;
+    }
+    
+    inline constexpr T getDerivative() const noexcept {
+        return derivative;
+    }
+    
+    inline constexpr T getOutput() const noexcept {
+        return output;
+    }
+    
+    // drops the accumulated state but keeps coefficients and target, the next compute() seeds the error again
+    // like the first one does, so there is no derivative kick after a reset
+    inline constexpr void reset() noexcept(core::numberNoexcept<T, TimeType>()) {
+        errold = T{};
+        integral = T{};
+        derivative = T{};
+        output = T{};
+        prevTime = TimeType{};
+    }
+    
     inline constexpr void clear(const TimeType& time = TimeType{}) noexcept(core::numberNoexcept<T, TimeType>()) {
         Kp = T{};
         Kd = T{};
         Kd = T{};
         errold  = T{};
         integral = T{};
+        derivative = T{};
+        output = T{};
         target = T{};
         prevTime = time;
     }
     
 };
 
+template <typename T> struct GainSchedulePoint {
+    T key{};
+    T Kp{};
+    T Ki{};
+    T Kd{};
+};
+
+// PID regulator whose coefficients are interpolated from a sorted table keyed by an operating variable.
+// The lookup starts from the segment used on the previous tick, so slowly changing keys cost O(1).
+// The integral term Ki * integral is accumulated as a whole, each step with the Ki of its tick, so a gain change
+// never moves the output, including through points where Ki is 0.
+template <typename T, typename TimeType = size_t, size_t Capacity = 8> class GainScheduledPIDRegulator : public PIDRegulator<T, TimeType> {
+protected:
+    GainSchedulePoint<T> table[Capacity]{};
+    size_t count = 0;
+    size_t segment = 0;
+    T integralTerm{};
+    
+    inline void locate(const T& key) noexcept {
+        if(segment + 1 >= count) segment = count >= 2 ? count - 2 : 0;
+        
+        while(segment > 0 && key < table[segment].key) segment--;
+        while(segment + 2 < count && !(key < table[segment + 1].key)) segment++;
+    }
+    
+public:
+    
+    GainScheduledPIDRegulator(const T& target = T{}) noexcept(core::numberNoexcept<T>()) : PIDRegulator<T, TimeType>(T{}, T{}, T{}, target) {}
+    
+    [[nodiscard]] core::Error addPoint(const GainSchedulePoint<T>& point) noexcept(core::numberNoexcept<T>()) {
+        if(count >= Capacity) return {core::ErrorCode::outOfRange, "The gain schedule table is full"};
+        
+        size_t index = count;
+        
+        for(; index > 0 && point.key < table[index - 1].key; index--) table[index] = table[index - 1];
+        
+        if(index > 0 && !(table[index - 1].key < point.key)) {
+            for(size_t i = index; i < count; i++) table[i] = table[i + 1];
+            return {core::ErrorCode::invalidArgument, "The gain schedule table already has a point with this key"};
+        }
+        
+        table[index] = point;
+        count++;
+        segment = 0;
+        
+        return {};
+    }
+    
+    // gains at the key, linear between points and held constant outside the table
+    [[nodiscard]] core::Result<GainSchedulePoint<T>> gainsAt(const T& key) noexcept(core::numberNoexcept<T>()) {
+        if(count == 0) return core::Error(core::ErrorCode::invalidConfiguration, "The gain schedule table is empty");
+        
+        GainSchedulePoint<T> gains;
+        gains.key = key;
+        
+        if(count == 1 || !(table[0].key < key)) {
+            gains = table[0];
+        } else if(!(key < table[count - 1].key)) {
+            gains = table[count - 1];
+        } else {
+            locate(key);
+            
+            const GainSchedulePoint<T>& a = table[segment];
+            const GainSchedulePoint<T>& b = table[segment + 1];
+            const T k = (key - a.key) / (b.key - a.key);
+            
+            gains.Kp = a.Kp + (b.Kp - a.Kp) * k;
+            gains.Ki = a.Ki + (b.Ki - a.Ki) * k;
+            gains.Kd = a.Kd + (b.Kd - a.Kd) * k;
+        }
+        
+        gains.key = key;
+        
+        return gains;
+    }
+    
+    [[nodiscard]] core::Error schedule(const T& key) noexcept(core::numberNoexcept<T>()) {
+        core::Result<GainSchedulePoint<T>> gains = gainsAt(key);
+        if(gains) return gains.error();
+        
+        this->setCoefficients(gains().Kp, gains().Ki, gains().Kd);
+        
+        return {};
+    }
+    
+    // the base compute() with the integral term accumulated instead of the bare integral
+    [[nodiscard]] T compute(const T& measured, const T& target, const TimeType& time) noexcept(core::numberNoexcept<T, TimeType>()) {
+        T error = target - measured;
+        
+        if (this->prevTime == 0) {
+            this->prevTime = time;
+            this->errold = error;
+            this->output = this->Kp * error + integralTerm;
+            return this->output;
+        }
+        
+        TimeType timeStep = time - this->prevTime;
+        
+        if(this->isIntegrationEnabled) {
+            this->integral += error * timeStep;
+            integralTerm += this->Ki * error * timeStep;
+        }
+        
+        this->derivative = (timeStep > 0) ? (error - this->errold) / static_cast<T>(timeStep) : 0;
+        
+        this->output = this->Kp * error + integralTerm + this->Kd * this->derivative;
+        
+        this->errold = error;
+        this->prevTime = time;
+        
+        return this->output;
+    }
+    
+    inline T compute(const T& measured, const TimeType& time) noexcept(core::numberNoexcept<T, TimeType>()) {
+        return compute(measured, this->target, time);
+    }
+    
+    [[nodiscard]] core::Result<T> compute(const T& measured, const T& target, const TimeType& time, const T& key) noexcept(core::numberNoexcept<T, TimeType>()) {
+        core::Error err = schedule(key);
+        if(err) return err;
+        
+        return compute(measured, target, time);
+    }
+    
+    inline constexpr T getIntegralTerm() const noexcept {
+        return integralTerm;
+    }
+    
+    inline constexpr void reset() noexcept(core::numberNoexcept<T, TimeType>()) {
+        PIDRegulator<T, TimeType>::reset();
+        integralTerm = T{};
+    }
+    
+    inline constexpr void clear(const TimeType& time = TimeType{}) noexcept(core::numberNoexcept<T, TimeType>()) {
+        PIDRegulator<T, TimeType>::clear(time);
+        integralTerm = T{};
+    }
+    
+    inline size_t size() const noexcept {
+        return count;
+    }
+};
+
 } // namespace vislib
@@ -0,0 +1,341 @@
+#pragma once
+
+// Host only: runs simulated responses on the fleet simulation thread pool.
+
+#if defined(__linux__)
+
+#include <vislib.hpp>
+
+#include <math.h>
+#include <stdio.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "pid.hpp"
+#include "simulation.hpp"
+#include "fleetSimulation.hpp"
+
+namespace vislib::simulation {
+
+struct PidGains {
+    double Kp = 0;
+    double Ki = 0;
+    double Kd = 0;
+
+    template <typename TimeType = double> PIDRegulator<double, TimeType> toRegulator() const noexcept {
+        return PIDRegulator<double, TimeType>(Kp, Ki, Kd);
+    }
+
+    // ready to paste into the robot code
+    std::string toConstructorString() const {
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), "PIDRegulator<double, double>(%.6g, %.6g, %.6g)", Kp, Ki, Kd);
+        return buffer;
+    }
+};
+
+struct ResponseScore {
+    double itae = 0;
+    double overshoot = 0;
+    double settlingTime = 0;
+    double cost = 0;
+    bool isStable = true;
+};
+
+// errors are normalized by the step size, overshoot is in percent of the step
+struct ScoreWeights {
+    double itae = 1;
+    double overshoot = 0.05;
+    double settlingTime = 1;
+    double settlingBand = 0.02;
+};
+
+class ResponseScorer {
+protected:
+    ScoreWeights weights{};
+    double target = 0;
+    double step = 1;
+    double startTime = 0;
+    double prevTime = 0;
+    bool hasSample = false;
+
+    ResponseScore score{};
+
+public:
+
+    ResponseScorer(double initial, double target, double startTime, const ScoreWeights& weights = {}) noexcept
+    : weights(weights), target(target), step(target - initial), startTime(startTime), prevTime(startTime) {
+        if(step == 0) step = 1;
+    }
+
+    void add(double time, double value) noexcept {
+        const double error = (target - value) / step;
+
+        if(!isfinite(error) || core::absF(error) > 100) {
+            score.isStable = false;
+            return;
+        }
+
+        const double elapsed = time - startTime;
+
+        score.itae += elapsed * core::absF(error) * (time - prevTime);
+        score.overshoot = fmax(score.overshoot, -error * 100);
+
+        if(core::absF(error) > weights.settlingBand || !hasSample) score.settlingTime = elapsed;
+
+        prevTime = time;
+        hasSample = true;
+    }
+
+    ResponseScore finish() const noexcept {
+        ResponseScore result = score;
+
+        if(!result.isStable || !hasSample) {
+            result.isStable = false;
+            result.cost = 1e9;
+            return result;
+        }
+
+        result.cost = weights.itae * result.itae + weights.overshoot * result.overshoot + weights.settlingTime * result.settlingTime;
+
+        return result;
+    }
+};
+
+struct HeadingStepConfig {
+    platform::PlatformMotorConfig motors;
+    SimulatedGyroConfig gyro{};
+    double motorTimeConstant = 0.03;
+    double stepAngle = 45;
+    double duration = 2;
+    double dt = 0.002;
+    ScoreWeights weights{};
+};
+
+// closes the loop of GyroPidCalculator around a simulated robot and scores the true heading after a head step
+inline ResponseScore simulateHeadingStep(const PidGains& gains, const HeadingStepConfig& config) noexcept {
+    platform::calculators::GyroPidCalculator<double> calculator(gains.toRegulator<double>(), config.motors);
+    SimulatedRobot robot(calculator, config.motors, config.gyro, config.motorTimeConstant);
+
+    robot.platform.setHead(core::Angle<>(config.stepAngle));
+
+    ResponseScorer scorer(0, config.stepAngle, 0, config.weights);
+    const size_t steps = static_cast<size_t>(config.duration / config.dt);
+
+    // PIDRegulator treats time 0 as "not started yet", so the simulation starts one step in
+    for(size_t i = 1; i <= steps; i++) {
+        const double time = i * config.dt;
+
+        if(robot.step(time, config.dt)) {
+            ResponseScore failed;
+            failed.isStable = false;
+            failed.cost = 1e9;
+            return failed;
+        }
+
+        scorer.add(time, robot.base.getState().heading);
+    }
+
+    return scorer.finish();
+}
+
+struct GainRange {
+    double min = 0;
+    double max = 0;
+    size_t steps = 1;
+
+    inline double at(size_t index) const noexcept {
+        return steps > 1 ? min + (max - min) * index / (steps - 1) : min;
+    }
+};
+
+struct TuningResult {
+    PidGains gains{};
+    ResponseScore score{};
+    size_t evaluations = 0;
+};
+
+// Coarse grid search followed by Nelder-Mead refinement from the best grid point. Every candidate set of a search
+// step (the whole grid, the initial simplex, the four trial points of a Nelder-Mead iteration) is evaluated at once
+// on the pool, so the search wall time scales with the core count.
+class PidAutotuner {
+public:
+    using Evaluator = std::function<ResponseScore(const PidGains&)>;
+
+protected:
+    WorkStealingPool& pool;
+    Evaluator evaluator;
+    size_t evaluations = 0;
+
+    static inline PidGains clampGains(PidGains gains) noexcept {
+        gains.Kp = fmax(gains.Kp, 0.0);
+        gains.Ki = fmax(gains.Ki, 0.0);
+        gains.Kd = fmax(gains.Kd, 0.0);
+        return gains;
+    }
+
+    static inline PidGains combine(const PidGains& a, const PidGains& b, double k) noexcept {
+        return clampGains({a.Kp + k * (b.Kp - a.Kp), a.Ki + k * (b.Ki - a.Ki), a.Kd + k * (b.Kd - a.Kd)});
+    }
+
+    std::vector<ResponseScore> evaluateAll(const std::vector<PidGains>& candidates) {
+        std::vector<ResponseScore> scores(candidates.size());
+
+        pool.parallelFor(candidates.size(), [&](size_t i) {
+            scores[i] = evaluator(candidates[i]);
+        }, 1);
+
+        evaluations += candidates.size();
+
+        return scores;
+    }
+
+public:
+
+    PidAutotuner(WorkStealingPool& pool, Evaluator evaluator) : pool(pool), evaluator(std::move(evaluator)) {}
+
+    PidAutotuner(WorkStealingPool& pool, const HeadingStepConfig& config)
+    : pool(pool), evaluator([config](const PidGains& gains) { return simulateHeadingStep(gains, config); }) {}
+
+    TuningResult gridSearch(const GainRange& kp, const GainRange& ki, const GainRange& kd) {
+        std::vector<PidGains> candidates;
+
+        for(size_t p = 0; p < kp.steps; p++) {
+            for(size_t i = 0; i < ki.steps; i++) {
+                for(size_t d = 0; d < kd.steps; d++) candidates.push_back(clampGains({kp.at(p), ki.at(i), kd.at(d)}));
+            }
+        }
+
+        const std::vector<ResponseScore> scores = evaluateAll(candidates);
+
+        TuningResult best;
+        best.score.cost = INFINITY;
+
+        for(size_t i = 0; i < candidates.size(); i++) {
+            if(scores[i].cost < best.score.cost) {
+                best.gains = candidates[i];
+                best.score = scores[i];
+            }
+        }
+
+        best.evaluations = evaluations;
+
+        return best;
+    }
+
+    TuningResult nelderMead(const PidGains& start, const PidGains& initialStep, size_t iterations, double tolerance = 1e-6) {
+        PidGains simplex[4] = {
+            start,
+            clampGains({start.Kp + initialStep.Kp, start.Ki, start.Kd}),
+            clampGains({start.Kp, start.Ki + initialStep.Ki, start.Kd}),
+            clampGains({start.Kp, start.Ki, start.Kd + initialStep.Kd})
+        };
+
+        std::vector<ResponseScore> scores = evaluateAll({simplex[0], simplex[1], simplex[2], simplex[3]});
+        ResponseScore values[4] = {scores[0], scores[1], scores[2], scores[3]};
+
+        for(size_t iteration = 0; iteration < iterations; iteration++) {
+            // sort the simplex from best to worst
+            for(size_t i = 1; i < 4; i++) {
+                for(size_t j = i; j > 0 && values[j].cost < values[j - 1].cost; j--) {
+                    const PidGains g = simplex[j];
+                    simplex[j] = simplex[j - 1];
+                    simplex[j - 1] = g;
+
+                    const ResponseScore s = values[j];
+                    values[j] = values[j - 1];
+                    values[j - 1] = s;
+                }
+            }
+
+            if(values[3].cost - values[0].cost < tolerance) break;
+
+            const PidGains centroid = {
+                (simplex[0].Kp + simplex[1].Kp + simplex[2].Kp) / 3,
+                (simplex[0].Ki + simplex[1].Ki + simplex[2].Ki) / 3,
+                (simplex[0].Kd + simplex[1].Kd + simplex[2].Kd) / 3
+            };
+
+            // reflection, expansion and both contractions are evaluated together instead of one after another
+            const std::vector<PidGains> trials = {
+                combine(centroid, simplex[3], -1),
+                combine(centroid, simplex[3], -2),
+                combine(centroid, simplex[3], -0.5),
+                combine(centroid, simplex[3], 0.5)
+            };
+
+            scores = evaluateAll(trials);
+
+            const ResponseScore& reflected = scores[0];
+
+            if(reflected.cost < values[0].cost) {
+                const size_t pick = scores[1].cost < reflected.cost ? 1 : 0;
+                simplex[3] = trials[pick];
+                values[3] = scores[pick];
+                continue;
+            }
+
+            if(reflected.cost < values[2].cost) {
+                simplex[3] = trials[0];
+                values[3] = reflected;
+                continue;
+            }
+
+            const size_t contraction = reflected.cost < values[3].cost ? 2 : 3;
+
+            if(scores[contraction].cost < core::minF(reflected.cost, values[3].cost)) {
+                simplex[3] = trials[contraction];
+                values[3] = scores[contraction];
+                continue;
+            }
+
+            // shrink towards the best vertex
+            for(size_t i = 1; i < 4; i++) simplex[i] = combine(simplex[0], simplex[i], 0.5);
+
+            scores = evaluateAll({simplex[1], simplex[2], simplex[3]});
+            for(size_t i = 1; i < 4; i++) values[i] = scores[i - 1];
+        }
+
+        size_t best = 0;
+        for(size_t i = 1; i < 4; i++) {
+            if(values[i].cost < values[best].cost) best = i;
+        }
+
+        TuningResult result;
+        result.gains = simplex[best];
+        result.score = values[best];
+        result.evaluations = evaluations;
+
+        return result;
+    }
+
+    TuningResult tune(const GainRange& kp, const GainRange& ki, const GainRange& kd, size_t iterations = 60) {
+        const TuningResult coarse = gridSearch(kp, ki, kd);
+
+        // the simplex starts one grid cell wide around the best grid point
+        const PidGains step = {
+            kp.steps > 1 ? (kp.max - kp.min) / (kp.steps - 1) : fmax(kp.max * 0.1, 1e-3),
+            ki.steps > 1 ? (ki.max - ki.min) / (ki.steps - 1) : fmax(ki.max * 0.1, 1e-3),
+            kd.steps > 1 ? (kd.max - kd.min) / (kd.steps - 1) : fmax(kd.max * 0.1, 1e-3)
+        };
+
+        TuningResult refined = nelderMead(coarse.gains, step, iterations);
+
+        if(coarse.score.cost < refined.score.cost) {
+            refined.gains = coarse.gains;
+            refined.score = coarse.score;
+        }
+
+        return refined;
+    }
+
+    inline size_t getEvaluations() const noexcept {
+        return evaluations;
+    }
+};
+
+} // namespace vislib::simulation
+
+#endif
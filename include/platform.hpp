@@ -2,6 +2,7 @@
 
 #include "motor.hpp"
 #include "pid.hpp"
+#include "gyro.hpp"
 
 namespace vislib::platform {
 
@@ -43,7 +44,7 @@ public:
         }
     }
     
-    [[nodiscard]] core::Error setSpeeds(PlatformMotorSpeeds speeds) noexcept {
+    [[nodiscard]] core::Error setSpeeds(const PlatformMotorSpeeds& speeds) noexcept {
         if (speeds.Size() != _controllers.Size()) {
             return {core::ErrorCode::invalidArgument, "Cannot apply speeds set to controller set as there are different amount of them"};
         }
@@ -61,7 +62,7 @@ public:
         return err;
     }
     
-    [[nodiscard]] core::Error setSpeedsInRanges(PlatformMotorSpeeds speeds, core::Array<motor::SpeedRange> ranges) noexcept {
+    [[nodiscard]] core::Error setSpeedsInRanges(const PlatformMotorSpeeds& speeds, const core::Array<motor::SpeedRange>& ranges) noexcept {
         if (speeds.Size() != _controllers.Size() || speeds.Size() != ranges.Size()) {
             return {core::ErrorCode::invalidArgument,
                 "Cannot apply speeds from different ranges set to controller set as there are different amounts of them"};
@@ -114,6 +115,10 @@ public:
     const core::Array<Controller>& controllers() const noexcept {
         return _controllers;
     }
+
+    core::Array<Controller>& controllers() noexcept {
+        return _controllers;
+    }
     
 };
 
@@ -158,6 +163,14 @@ namespace calculators {
     return speeds;
 }
 
+[[nodiscard]] inline bool areSpeedsZero(const PlatformMotorSpeeds& speeds, const motor::Speed& tolerance = 0) noexcept {
+    for(size_t i = 0; i < speeds.Size(); i++) {
+        if(core::absF(speeds[i]) > tolerance) return false;
+    }
+    
+    return true;
+}
+
 template<typename TimeType> class GyroPidCalculator {
 public:
     PIDRegulator<double, TimeType> pid;
@@ -166,6 +179,14 @@ public:
     GyroPidCalculator(const PIDRegulator<double, TimeType>& pid, const PlatformMotorConfig& config) noexcept
     : pid(pid), config(config) { }
 
+    double computeCorrection(TimeType time, const core::Angle<>& absCurrentAngle, const core::Angle<>& absMaintainAngle) noexcept {
+        
+        // regulate the shortest rotation so crossing the 180/-180 seam doesn't produce an error spike
+        const double error = gyro::shortestAngleDifference(absCurrentAngle.deg(), absMaintainAngle.deg());
+        
+        return pid.compute(-error, 0, time);
+    }
+
     core::Result<PlatformMotorSpeeds> calculateSpeeds(
         TimeType time,
         const core::Angle<>& relTargetAngle,
@@ -176,7 +197,7 @@ public:
         const double speedK = 1
     ) noexcept {
         
-        return calculatePlatformSpeeds(config, relTargetAngle.deg(), speed, speedK, angularSpeed + pid.compute(absCurrentAngle.deg(), absMaintainAngle.deg(), time));
+        return calculatePlatformSpeeds(config, relTargetAngle.deg(), speed, speedK, angularSpeed + computeCorrection(time, absCurrentAngle, absMaintainAngle));
     }
 };
 
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <vislib.hpp>
+
+#include "pid.hpp"
+
+#include <math.h>
+
+namespace vislib {
+
+enum class RelayTuningRule {
+    zieglerNicholsPI,
+    zieglerNicholsPID,
+    tyreusLuybenPI,
+    tyreusLuybenPID
+};
+
+template <typename T, typename TimeType = size_t> struct RelayAutotunerConfig {
+    T relayAmplitude{};
+    T hysteresis{};
+    size_t settleCycles = 2;
+    size_t measureCycles = 4;
+    TimeType timeout{};
+    RelayTuningRule rule = RelayTuningRule::tyreusLuybenPID;
+};
+
+template <typename T, typename TimeType = size_t> struct RelayTuningResult {
+    T ultimateGain{};
+    TimeType ultimatePeriod{};
+    T amplitude{};
+    T Kp{};
+    T Ki{};
+    T Kd{};
+};
+
+// Astrom-Hagglund relay experiment: the output switches between +d and -d around the setpoint, which makes
+// the loop oscillate at its ultimate period. Only the extremes of the current cycle and running sums are kept,
+// so memory doesn't grow with the experiment length. Ku = 4d / (pi * sqrt(a^2 - e^2)) with a the oscillation
+// amplitude and e the hysteresis, gains then follow the configured tuning rule.
+template <typename T, typename TimeType = size_t> class RelayAutotuner {
+protected:
+    RelayAutotunerConfig<T, TimeType> config{};
+
+    T setpoint{};
+    T output{};
+    TimeType startTime{};
+    TimeType lastRise{};
+    bool hasRise = false;
+
+    T cycleMax{};
+    T cycleMin{};
+    bool hasCycleSample = false;
+
+    size_t cycles = 0;
+    T periodSum{};
+    T amplitudeSum{};
+
+    bool isRunning = false;
+    bool isDone = false;
+
+    inline void completeCycle(const TimeType& time) noexcept {
+        if(hasRise && hasCycleSample) {
+            cycles++;
+
+            if(cycles > config.settleCycles) {
+                periodSum += static_cast<T>(time - lastRise);
+                amplitudeSum += (cycleMax - cycleMin) / 2;
+            }
+
+            if(cycles >= config.settleCycles + config.measureCycles) isDone = true;
+        }
+
+        lastRise = time;
+        hasRise = true;
+        hasCycleSample = false;
+    }
+
+public:
+
+    RelayAutotuner() = default;
+
+    RelayAutotuner(const RelayAutotunerConfig<T, TimeType>& config) noexcept : config(config) {}
+
+    [[nodiscard]] core::Error start(const T& setpoint, const TimeType& time) noexcept {
+        if(!(config.relayAmplitude > T{})) return {core::ErrorCode::invalidConfiguration, "Relay amplitude must be positive"};
+
+        if(config.hysteresis < T{}) return {core::ErrorCode::invalidConfiguration, "Relay hysteresis cannot be negative"};
+
+        if(config.measureCycles == 0) return {core::ErrorCode::invalidConfiguration, "Relay autotuner needs at least one measured cycle"};
+
+        this->setpoint = setpoint;
+        startTime = time;
+        output = config.relayAmplitude;
+        hasRise = false;
+        hasCycleSample = false;
+        cycles = 0;
+        periodSum = T{};
+        amplitudeSum = T{};
+        isRunning = true;
+        isDone = false;
+
+        return {};
+    }
+
+    // returns the relay output to apply instead of the regulator output
+    [[nodiscard]] core::Result<T> update(const T& measured, const TimeType& time) noexcept {
+        if(!isRunning) return core::Error(core::ErrorCode::invalidConfiguration, "The relay autotuner isn't started");
+
+        if(isDone) return T{};
+
+        if(config.timeout > TimeType{} && config.timeout < time - startTime) {
+            isRunning = false;
+            return core::Error(core::ErrorCode::outOfRange, "The relay experiment didn't settle into oscillation before the timeout");
+        }
+
+        if(!hasCycleSample) {
+            cycleMax = measured;
+            cycleMin = measured;
+            hasCycleSample = true;
+        } else {
+            if(cycleMax < measured) cycleMax = measured;
+            if(measured < cycleMin) cycleMin = measured;
+        }
+
+        const T error = setpoint - measured;
+
+        if(output < T{} && error > config.hysteresis) {
+            output = config.relayAmplitude;
+            completeCycle(time);
+        } else if(output > T{} && error < -config.hysteresis) {
+            output = -config.relayAmplitude;
+        }
+
+        return isDone ? T{} : output;
+    }
+
+    inline bool isFinished() const noexcept {
+        return isDone;
+    }
+
+    inline bool isActive() const noexcept {
+        return isRunning && !isDone;
+    }
+
+    inline size_t getCycles() const noexcept {
+        return cycles;
+    }
+
+    [[nodiscard]] core::Result<RelayTuningResult<T, TimeType>> getResult() const noexcept {
+        if(!isDone) return core::Error(core::ErrorCode::invalidConfiguration, "The relay experiment isn't finished yet");
+
+        RelayTuningResult<T, TimeType> result;
+
+        const T period = periodSum / static_cast<T>(config.measureCycles);
+        result.amplitude = amplitudeSum / static_cast<T>(config.measureCycles);
+        result.ultimatePeriod = static_cast<TimeType>(period);
+
+        const T squared = result.amplitude * result.amplitude - config.hysteresis * config.hysteresis;
+
+        if(!(squared > T{}) || !(period > T{})) {
+            return core::Error(core::ErrorCode::invalidResource, "The measured oscillation is too small to estimate the ultimate gain");
+        }
+
+        result.ultimateGain = 4 * config.relayAmplitude / (static_cast<T>(3.14159265358979323846) * static_cast<T>(sqrt(squared)));
+
+        const T Ku = result.ultimateGain;
+
+        switch(config.rule) {
+            case RelayTuningRule::zieglerNicholsPI:
+                result.Kp = static_cast<T>(0.45) * Ku;
+                result.Ki = result.Kp * static_cast<T>(1.2) / period;
+                break;
+            case RelayTuningRule::zieglerNicholsPID:
+                result.Kp = static_cast<T>(0.6) * Ku;
+                result.Ki = result.Kp * 2 / period;
+                result.Kd = result.Kp * period / 8;
+                break;
+            case RelayTuningRule::tyreusLuybenPI:
+                result.Kp = Ku / static_cast<T>(3.2);
+                result.Ki = result.Kp / (static_cast<T>(2.2) * period);
+                break;
+            case RelayTuningRule::tyreusLuybenPID:
+                result.Kp = Ku / static_cast<T>(2.2);
+                result.Ki = result.Kp / (static_cast<T>(2.2) * period);
+                result.Kd = result.Kp * period / static_cast<T>(6.3);
+                break;
+        }
+
+        return result;
+    }
+
+    // sets the tuned coefficients and restarts the regulator state, its next compute() seeds it again
+    [[nodiscard]] core::Error applyTo(PIDRegulator<T, TimeType>& regulator) const noexcept {
+        core::Result<RelayTuningResult<T, TimeType>> result = getResult();
+        if(result) return result.error();
+
+        regulator.setCoefficients(result().Kp, result().Ki, result().Kd);
+        regulator.reset();
+
+        return {};
+    }
+};
+
+} // namespace vislib
@@ -0,0 +1,577 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <stdio.h>
+#endif
+
+#include "gyro.hpp"
+
+namespace vislib::replay {
+
+// Log: magic(4) | version(1), then entries: channel(1) | payload length(1) | payload.
+// Values are 8 bytes little endian whatever their size on the recording target: floating point as binary64,
+// integers as 64 bit two's complement, so a log taken on a board with 4 byte double and long replays on a host.
+// An entry with the error flag set in its channel carries the u16 error code returned by the recorded getter.
+// Each getter or clock writes into its own channel, on replay every channel is consumed in recording order,
+// so a pipeline calling its inputs in the same sequence sees exactly the recorded values.
+
+constexpr uint8_t logMagic[4] = {'V', 'R', 'P', 'L'};
+constexpr uint8_t logVersion = 2;
+constexpr size_t logHeaderSize = 5;
+constexpr uint8_t errorChannelFlag = 0x80;
+constexpr size_t maxEntryPayload = 255;
+
+enum Channel : uint8_t {
+    timeChannel = 0,
+    yawChannel = 1,
+    angularSpeedChannel = 2,
+    accelerationChannel = 3
+};
+
+constexpr size_t logValueSize = 8;
+
+template <typename T> constexpr bool isFloatingValue = T(1) / T(2) != T(0);
+
+inline void putLittleEndian(uint8_t* out, uint64_t bits) noexcept {
+    for(size_t i = 0; i < logValueSize; i++) out[i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+inline uint64_t getLittleEndian(const uint8_t* in) noexcept {
+    uint64_t bits = 0;
+    for(size_t i = 0; i < logValueSize; i++) bits |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return bits;
+}
+
+// binary32 <-> binary64 on the bits, for targets where double is a 4 byte float. Widening is exact,
+// narrowing rounds to nearest even.
+inline uint64_t widenBinary32(uint32_t bits) noexcept {
+    const uint64_t sign = static_cast<uint64_t>(bits >> 31) << 63;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF);
+    uint64_t mantissa = bits & 0x7FFFFF;
+
+    if(exponent == 0xFF) return sign | (static_cast<uint64_t>(0x7FF) << 52) | (mantissa << 29);
+
+    if(exponent == 0) {
+        if(mantissa == 0) return sign;
+
+        exponent = 1;
+        while(!(mantissa & 0x800000)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        mantissa &= 0x7FFFFF;
+    }
+
+    return sign | (static_cast<uint64_t>(exponent + 896) << 52) | (mantissa << 29);
+}
+
+inline uint32_t narrowBinary64(uint64_t bits) noexcept {
+    const uint32_t sign = static_cast<uint32_t>(bits >> 63) << 31;
+    const int32_t exponent = static_cast<int32_t>((bits >> 52) & 0x7FF) - 896;
+    const uint64_t mantissa = bits & ((static_cast<uint64_t>(1) << 52) - 1);
+
+    if(exponent == 0x7FF - 896) return sign | 0x7F800000u | (mantissa != 0 ? 0x400000u : 0u);
+    if(exponent >= 0xFF) return sign | 0x7F800000u;
+    if(exponent < -23) return sign;
+
+    // the dropped bits decide the rounding, a carry out of the mantissa correctly bumps the exponent
+    const uint64_t full = exponent > 0 ? mantissa : mantissa | (static_cast<uint64_t>(1) << 52);
+    const int shift = exponent > 0 ? 29 : 30 - exponent;
+    const uint64_t rest = full & ((static_cast<uint64_t>(1) << shift) - 1);
+    const uint64_t half = static_cast<uint64_t>(1) << (shift - 1);
+
+    uint32_t result = static_cast<uint32_t>(full >> shift);
+    if(exponent > 0) result |= static_cast<uint32_t>(exponent) << 23;
+    if(rest > half || (rest == half && (result & 1))) result++;
+
+    return sign | result;
+}
+
+template <typename T> struct LogValue {
+    static constexpr size_t size = logValueSize;
+
+    static inline void write(uint8_t* out, const T& value) noexcept {
+        if constexpr (isFloatingValue<T>) {
+            const double wide = static_cast<double>(value);
+
+            if constexpr (sizeof(double) == 8) {
+                uint64_t bits;
+                memcpy(&bits, &wide, sizeof(bits));
+                putLittleEndian(out, bits);
+            } else {
+                uint32_t bits;
+                memcpy(&bits, &wide, sizeof(bits));
+                putLittleEndian(out, widenBinary32(bits));
+            }
+        } else {
+            putLittleEndian(out, static_cast<uint64_t>(value));
+        }
+    }
+
+    static inline T read(const uint8_t* in) noexcept {
+        const uint64_t bits = getLittleEndian(in);
+
+        if constexpr (isFloatingValue<T>) {
+            double wide;
+
+            if constexpr (sizeof(double) == 8) {
+                memcpy(&wide, &bits, sizeof(wide));
+            } else {
+                const uint32_t narrow = narrowBinary64(bits);
+                memcpy(&wide, &narrow, sizeof(narrow));
+            }
+
+            return static_cast<T>(wide);
+        } else {
+            return static_cast<T>(bits);
+        }
+    }
+};
+
+template <> struct LogValue<core::Angle<>> {
+    static constexpr size_t size = logValueSize;
+
+    static inline void write(uint8_t* out, const core::Angle<>& value) noexcept {
+        LogValue<double>::write(out, value.deg());
+    }
+
+    static inline core::Angle<> read(const uint8_t* in) noexcept {
+        return core::Angle<>(LogValue<double>::read(in));
+    }
+};
+
+class LogSink {
+public:
+    virtual core::Error write(const uint8_t* data, size_t size) = 0;
+    virtual ~LogSink() = default;
+};
+
+class BufferLogSink : public LogSink {
+protected:
+    uint8_t* buffer = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+
+public:
+
+    BufferLogSink(uint8_t* buffer, size_t capacity) noexcept : buffer(buffer), capacity(capacity) {}
+
+    core::Error write(const uint8_t* data, size_t size) override {
+        if(capacity - used < size) return {core::ErrorCode::outOfRange, "The replay log buffer is full"};
+
+        memcpy(buffer + used, data, size);
+        used += size;
+
+        return {};
+    }
+
+    inline size_t size() const noexcept {
+        return used;
+    }
+
+    ~BufferLogSink() override = default;
+};
+
+#if defined(__linux__)
+
+class FileLogSink : public LogSink {
+protected:
+    FILE* file = nullptr;
+
+public:
+
+    FileLogSink(const char* path) noexcept : file(fopen(path, "wb")) {}
+
+    FileLogSink(const FileLogSink&) = delete;
+    FileLogSink& operator=(const FileLogSink&) = delete;
+
+    inline bool isOpen() const noexcept {
+        return file != nullptr;
+    }
+
+    core::Error write(const uint8_t* data, size_t size) override {
+        if(file == nullptr) return {core::ErrorCode::invalidResource, "The replay log file is not open"};
+
+        if(fwrite(data, 1, size, file) != size) return {core::ErrorCode::invalidResource, "Failed writing the replay log file"};
+
+        return {};
+    }
+
+    ~FileLogSink() override {
+        if(file != nullptr) fclose(file);
+    }
+};
+
+#endif
+
+class LogRecorder {
+protected:
+    LogSink* sink = nullptr;
+    bool hasHeader = false;
+    size_t failedWrites = 0;
+
+    void writeHeader() noexcept {
+        uint8_t header[logHeaderSize] = {logMagic[0], logMagic[1], logMagic[2], logMagic[3], logVersion};
+
+        if(sink->write(header, sizeof(header))) failedWrites++;
+
+        hasHeader = true;
+    }
+
+public:
+
+    LogRecorder() = default;
+
+    LogRecorder(LogSink* sink) noexcept : sink(sink) {}
+
+    // recording must never disturb the recorded pipeline, so sink failures are only counted
+    void record(uint8_t channel, const uint8_t* payload, size_t size) noexcept {
+        if(sink == nullptr || size > maxEntryPayload) {
+            failedWrites++;
+            return;
+        }
+
+        if(!hasHeader) writeHeader();
+
+        uint8_t entry[2 + maxEntryPayload];
+        entry[0] = channel;
+        entry[1] = static_cast<uint8_t>(size);
+        memcpy(entry + 2, payload, size);
+
+        if(sink->write(entry, size + 2)) failedWrites++;
+    }
+
+    template <typename T> void recordValue(uint8_t channel, const T& value) noexcept {
+        uint8_t payload[LogValue<T>::size];
+        LogValue<T>::write(payload, value);
+        record(channel, payload, sizeof(payload));
+    }
+
+    template <typename T> void recordVector(uint8_t channel, const core::Vector<T>& vector) noexcept {
+        uint8_t payload[maxEntryPayload];
+        const size_t count = core::minF(vector.Size(), maxEntryPayload / LogValue<T>::size);
+
+        for(size_t i = 0; i < count; i++) LogValue<T>::write(payload + i * LogValue<T>::size, vector[i]);
+
+        record(channel, payload, count * LogValue<T>::size);
+    }
+
+    void recordError(uint8_t channel, const core::Error& error) noexcept {
+        const uint16_t code = static_cast<uint16_t>(error.errcode);
+        const uint8_t payload[2] = {static_cast<uint8_t>(code & 0xFF), static_cast<uint8_t>(code >> 8)};
+        record(channel | errorChannelFlag, payload, sizeof(payload));
+    }
+
+    inline size_t getFailedWrites() const noexcept {
+        return failedWrites;
+    }
+};
+
+// recording wrappers, each forwards to the real source and logs what it returned
+
+template <typename T> class RecordingYawGetter : public gyro::YawGetter<T> {
+protected:
+    const gyro::YawGetter<T>* source = nullptr;
+    LogRecorder* recorder = nullptr;
+    uint8_t channel = yawChannel;
+
+public:
+
+    RecordingYawGetter(const gyro::YawGetter<T>* source, LogRecorder* recorder, uint8_t channel = yawChannel) noexcept
+    : source(source), recorder(recorder), channel(channel) {}
+
+    core::Result<T> getYaw() const noexcept(core::numberNoexcept<T>()) override {
+        core::Result<T> yaw = source->getYaw();
+
+        if(yaw) recorder->recordError(channel, yaw.error());
+        else recorder->recordValue(channel, yaw());
+
+        return yaw;
+    }
+
+    ~RecordingYawGetter() override = default;
+};
+
+template <typename T> class RecordingAngularSpeedGetter : public gyro::AngularSpeedGetter<T> {
+protected:
+    const gyro::AngularSpeedGetter<T>* source = nullptr;
+    LogRecorder* recorder = nullptr;
+    uint8_t channel = angularSpeedChannel;
+
+public:
+
+    RecordingAngularSpeedGetter(const gyro::AngularSpeedGetter<T>* source, LogRecorder* recorder, uint8_t channel = angularSpeedChannel) noexcept
+    : source(source), recorder(recorder), channel(channel) {}
+
+    core::Result<gyro::AngularSpeed<T>> getAngularSpeed() const noexcept(core::numberNoexcept<T>()) override {
+        core::Result<gyro::AngularSpeed<T>> speed = source->getAngularSpeed();
+
+        if(speed) recorder->recordError(channel, speed.error());
+        else recorder->recordVector(channel, speed());
+
+        return speed;
+    }
+
+    ~RecordingAngularSpeedGetter() override = default;
+};
+
+template <typename T> class RecordingAccelerationGetter : public gyro::AccelerationGetter<T> {
+protected:
+    const gyro::AccelerationGetter<T>* source = nullptr;
+    LogRecorder* recorder = nullptr;
+    uint8_t channel = accelerationChannel;
+
+public:
+
+    RecordingAccelerationGetter(const gyro::AccelerationGetter<T>* source, LogRecorder* recorder, uint8_t channel = accelerationChannel) noexcept
+    : source(source), recorder(recorder), channel(channel) {}
+
+    core::Result<gyro::Acceleration<T>> getAcceleration() const noexcept(core::numberNoexcept<T>()) override {
+        core::Result<gyro::Acceleration<T>> acceleration = source->getAcceleration();
+
+        if(acceleration) recorder->recordError(channel, acceleration.error());
+        else recorder->recordVector(channel, acceleration());
+
+        return acceleration;
+    }
+
+    ~RecordingAccelerationGetter() override = default;
+};
+
+template <typename Time_t, typename Clock_t = core::TimeGetter<Time_t>> class RecordingClock {
+protected:
+    Clock_t clock{};
+    LogRecorder* recorder = nullptr;
+    uint8_t channel = timeChannel;
+
+public:
+
+    RecordingClock(Clock_t clock, LogRecorder* recorder, uint8_t channel = timeChannel) noexcept
+    : clock(core::move(clock)), recorder(recorder), channel(channel) {}
+
+    Time_t operator()() noexcept {
+        const Time_t time = clock();
+        recorder->recordValue(channel, time);
+        return time;
+    }
+};
+
+// replay side, reads a log held in memory
+
+struct LogEntry {
+    bool isError = false;
+    const uint8_t* payload = nullptr;
+    size_t size = 0;
+};
+
+class LogReplayer {
+protected:
+    static constexpr size_t maxChannels = 16;
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t cursors[maxChannels]{};
+
+public:
+
+    LogReplayer() = default;
+
+    [[nodiscard]] core::Error open(const uint8_t* data, size_t size) noexcept {
+        if(data == nullptr || size < logHeaderSize || memcmp(data, logMagic, sizeof(logMagic)) != 0) {
+            return {core::ErrorCode::invalidResource, "The replay log has no valid signature"};
+        }
+
+        if(data[4] != logVersion) return {core::ErrorCode::invalidResource, "The replay log was written by unsupported format version"};
+
+        this->data = data;
+        this->size = size;
+
+        for(size_t i = 0; i < maxChannels; i++) cursors[i] = logHeaderSize;
+
+        return {};
+    }
+
+    [[nodiscard]] core::Result<LogEntry> next(uint8_t channel) noexcept {
+        if(channel >= maxChannels) return core::Error(core::ErrorCode::outOfRange, "The replay channel is out of supported range");
+
+        size_t& cursor = cursors[channel];
+
+        while(cursor + 2 <= size) {
+            const uint8_t entryChannel = data[cursor];
+            const size_t entrySize = data[cursor + 1];
+            const size_t payload = cursor + 2;
+
+            if(payload + entrySize > size) break;
+
+            cursor = payload + entrySize;
+
+            if((entryChannel & ~errorChannelFlag) != channel) continue;
+
+            LogEntry entry;
+            entry.isError = entryChannel & errorChannelFlag;
+            entry.payload = data + payload;
+            entry.size = entrySize;
+
+            return entry;
+        }
+
+        cursor = size;
+
+        return core::Error(core::ErrorCode::outOfRange, "The replay log is exhausted");
+    }
+
+    bool isFinished(uint8_t channel) const noexcept {
+        return channel >= maxChannels || cursors[channel] >= size;
+    }
+
+    static core::Error entryError(const LogEntry& entry) noexcept {
+        const uint16_t code = entry.size >= 2 ? static_cast<uint16_t>(entry.payload[0] | (entry.payload[1] << 8)) : 0;
+        return {static_cast<core::ErrorCode>(code), "Replayed recorded error"};
+    }
+
+    template <typename T> [[nodiscard]] core::Result<T> nextValue(uint8_t channel) noexcept {
+        core::Result<LogEntry> entry = next(channel);
+        if(entry) return entry.error();
+
+        if(entry().isError) return entryError(entry());
+
+        if(entry().size != LogValue<T>::size) return core::Error(core::ErrorCode::invalidResource, "The replayed entry has unexpected size");
+
+        return LogValue<T>::read(entry().payload);
+    }
+
+    template <typename T> [[nodiscard]] core::Result<core::Vector<T>> nextVector(uint8_t channel) noexcept {
+        core::Result<LogEntry> entry = next(channel);
+        if(entry) return entry.error();
+
+        if(entry().isError) return entryError(entry());
+
+        const size_t count = entry().size / LogValue<T>::size;
+        core::Vector<T> vector(count);
+
+        for(size_t i = 0; i < count; i++) vector[i] = LogValue<T>::read(entry().payload + i * LogValue<T>::size);
+
+        return vector;
+    }
+};
+
+template <typename T> class ReplayYawGetter : public gyro::YawGetter<T> {
+protected:
+    LogReplayer* replayer = nullptr;
+    uint8_t channel = yawChannel;
+
+public:
+
+    ReplayYawGetter(LogReplayer* replayer, uint8_t channel = yawChannel) noexcept : replayer(replayer), channel(channel) {}
+
+    core::Result<T> getYaw() const noexcept(core::numberNoexcept<T>()) override {
+        return replayer->template nextValue<T>(channel);
+    }
+
+    ~ReplayYawGetter() override = default;
+};
+
+template <typename T> class ReplayAngularSpeedGetter : public gyro::AngularSpeedGetter<T> {
+protected:
+    LogReplayer* replayer = nullptr;
+    uint8_t channel = angularSpeedChannel;
+
+public:
+
+    ReplayAngularSpeedGetter(LogReplayer* replayer, uint8_t channel = angularSpeedChannel) noexcept : replayer(replayer), channel(channel) {}
+
+    core::Result<gyro::AngularSpeed<T>> getAngularSpeed() const noexcept(core::numberNoexcept<T>()) override {
+        return replayer->template nextVector<T>(channel);
+    }
+
+    ~ReplayAngularSpeedGetter() override = default;
+};
+
+template <typename T> class ReplayAccelerationGetter : public gyro::AccelerationGetter<T> {
+protected:
+    LogReplayer* replayer = nullptr;
+    uint8_t channel = accelerationChannel;
+
+public:
+
+    ReplayAccelerationGetter(LogReplayer* replayer, uint8_t channel = accelerationChannel) noexcept : replayer(replayer), channel(channel) {}
+
+    core::Result<gyro::Acceleration<T>> getAcceleration() const noexcept(core::numberNoexcept<T>()) override {
+        return replayer->template nextVector<T>(channel);
+    }
+
+    ~ReplayAccelerationGetter() override = default;
+};
+
+// Returns recorded timestamps instead of waiting for real time, so replays run as fast as the host allows.
+// A clock can't return an error, so the first failed read is latched: the clock keeps returning the last
+// timestamp and the run must check getError(), a truncated or mismatched log would otherwise freeze time.
+template <typename Time_t> class ReplayClock {
+protected:
+    LogReplayer* replayer = nullptr;
+    uint8_t channel = timeChannel;
+    Time_t last{};
+    core::Error error{};
+
+public:
+
+    ReplayClock(LogReplayer* replayer, uint8_t channel = timeChannel) noexcept : replayer(replayer), channel(channel) {}
+
+    Time_t operator()() noexcept {
+        if(error) return last;
+
+        core::Result<Time_t> time = replayer->template nextValue<Time_t>(channel);
+        if(time) {
+            error = time.error();
+            return last;
+        }
+
+        last = time();
+
+        return last;
+    }
+
+    inline bool isFinished() const noexcept {
+        return error.isError() || replayer->isFinished(channel);
+    }
+
+    inline bool hasError() const noexcept {
+        return error.isError();
+    }
+
+    inline core::Error getError() const noexcept {
+        return error;
+    }
+};
+
+#if defined(__linux__)
+
+[[nodiscard]] inline core::Result<core::Array<uint8_t>> loadLogFile(const char* path) noexcept {
+    FILE* file = fopen(path, "rb");
+    if(file == nullptr) return core::Error(core::ErrorCode::invalidResource, "Cannot open the replay log file");
+
+    fseek(file, 0, SEEK_END);
+    const long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if(length <= 0) {
+        fclose(file);
+        return core::Error(core::ErrorCode::invalidResource, "The replay log file is empty");
+    }
+
+    core::Array<uint8_t> data(static_cast<size_t>(length));
+    const size_t got = fread(&data[0], 1, data.Size(), file);
+    fclose(file);
+
+    if(got != data.Size()) return core::Error(core::ErrorCode::invalidResource, "Failed reading the replay log file");
+
+    return data;
+}
+
+#endif
+
+} // namespace vislib::replay
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vislib.hpp>
+
+namespace vislib {
+
+using TaskFunctor = core::Callable<core::Error>;
+
+template <typename Time_t> struct ScheduledTask {
+    TaskFunctor functor{};
+    Time_t period{};
+    Time_t nextRelease{};
+
+    size_t runs = 0;
+    size_t missedReleases = 0;
+    size_t overruns = 0;
+};
+
+// Static rate monotonic executor: tasks are kept sorted by period, so faster loops always get the processor first.
+// Every tick() the clock is re-read after each task and the highest priority released task runs next, each task at
+// most once per tick. A release that comes later than one period is skipped and counted as missed, a task finishing
+// after its deadline (release + period) is counted as an overrun.
+template <typename Time_t, size_t Capacity, typename Clock_t = core::TimeGetter<Time_t>> class MultiRateExecutor {
+protected:
+    ScheduledTask<Time_t> tasks[Capacity]{};
+    size_t count = 0;
+    Clock_t timeGetter{};
+    bool isStarted = false;
+
+public:
+
+    MultiRateExecutor() = default;
+
+    MultiRateExecutor(Clock_t timeGetter) noexcept : timeGetter(core::move(timeGetter)) {}
+
+    [[nodiscard]] core::Error addTask(const Time_t& period, const TaskFunctor& functor) noexcept {
+        if(count >= Capacity) return {core::ErrorCode::outOfRange, "The executor has no free task slots"};
+
+        if(!(period > Time_t{})) return {core::ErrorCode::invalidArgument, "The task period must be positive"};
+
+        if(isStarted) return {core::ErrorCode::invalidConfiguration, "Cannot add tasks to an already started executor"};
+
+        size_t index = count;
+
+        for(; index > 0 && period < tasks[index - 1].period; index--) tasks[index] = tasks[index - 1];
+
+        tasks[index] = ScheduledTask<Time_t>{};
+        tasks[index].functor = functor;
+        tasks[index].period = period;
+
+        count++;
+
+        return {};
+    }
+
+    void start() noexcept {
+        const Time_t now = timeGetter();
+
+        for(size_t i = 0; i < count; i++) tasks[i].nextRelease = now;
+
+        isStarted = true;
+    }
+
+    [[nodiscard]] core::Error tick() noexcept {
+        if(!isStarted) start();
+
+        bool isExecuted[Capacity]{};
+
+        for(size_t step = 0; step < count; step++) {
+            const Time_t now = timeGetter();
+
+            size_t i = 0;
+            for(; i < count && (isExecuted[i] || now < tasks[i].nextRelease); i++);
+
+            if(i == count) break;
+
+            ScheduledTask<Time_t>& task = tasks[i];
+            isExecuted[i] = true;
+
+            const size_t missed = static_cast<size_t>((now - task.nextRelease) / task.period);
+            task.missedReleases += missed;
+
+            const Time_t deadline = task.nextRelease + task.period * static_cast<Time_t>(missed + 1);
+
+            core::Error err = task.functor.execute();
+            task.runs++;
+            task.nextRelease = deadline;
+
+            if(deadline < timeGetter()) task.overruns++;
+
+            if(err) return err;
+        }
+
+        return {};
+    }
+
+    inline size_t size() const noexcept {
+        return count;
+    }
+
+    // tasks are indexed in priority order, i.e. by ascending period
+    [[nodiscard]] core::Result<ScheduledTask<Time_t>> getTaskStats(size_t index) const noexcept {
+        if(index >= count) return core::Error(core::ErrorCode::outOfRange, "The task index " + core::to_string(index) + " is out of executor range");
+
+        return tasks[index];
+    }
+
+    size_t totalOverruns() const noexcept {
+        size_t total = 0;
+
+        for(size_t i = 0; i < count; i++) total += tasks[i].overruns;
+
+        return total;
+    }
+};
+
+} // namespace vislib
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <math.h>
+#include <stdint.h>
+
+#include "motor.hpp"
+#include "gyro.hpp"
+#include "platform.hpp"
+
+namespace vislib::simulation {
+
+constexpr double degreesToRadians = 3.14159265358979323846 / 180.0;
+
+// Motor with first order lag: the raw speed approaches the commanded one with the given time constant.
+// Constructible from MotorInfo, so Platform<SimulatedMotorController> builds its controllers as usual.
+class SimulatedMotorController : public motor::controllers::RangedSpeedController {
+protected:
+    motor::Speed target{};
+    motor::Speed current{};
+    double timeConstant = 0;
+
+    core::Error setSpeedRaw(motor::Speed speed) override {
+        target = speed;
+        return {};
+    }
+
+    core::Result<motor::Speed> getSpeedRaw() const override {
+        return current;
+    }
+
+public:
+
+    SimulatedMotorController() = default;
+
+    SimulatedMotorController(const motor::MotorInfo& info, double timeConstant = 0) noexcept
+    : RangedSpeedController(info), timeConstant(timeConstant) {}
+
+    inline void setTimeConstant(double timeConstant) noexcept {
+        this->timeConstant = timeConstant;
+    }
+
+    inline double getTimeConstant() const noexcept {
+        return timeConstant;
+    }
+
+    inline motor::Speed getTargetRaw() const noexcept {
+        return target;
+    }
+
+    void step(double dt) noexcept {
+        if(timeConstant <= 0 || dt <= 0) {
+            current = target;
+            return;
+        }
+
+        current += (target - current) * (1 - exp(-dt / timeConstant));
+    }
+
+    void reset() noexcept {
+        target = 0;
+        current = 0;
+    }
+
+    ~SimulatedMotorController() override = default;
+};
+
+struct BodyState {
+    double x{};
+    double y{};
+    double heading{};
+    double velocityX{};
+    double velocityY{};
+    double angularSpeed{};
+    double accelerationX{};
+    double accelerationY{};
+};
+
+// Rigid holonomic base. Each wheel contributes s_i * R_i = cos(a_i) * vx / n_i + sin(a_i) * vy / n_i + d_i * w,
+// the inverse of calculatePlatformSpeeds, and body velocity is its least squares solution over all wheels.
+// Body velocity and accelerations are in the platform frame, heading is in degrees, w is in radians per time unit.
+// Platform angles turn opposite to the heading the way go() maps directions: platform angle a points along
+// heading - a in the world.
+class SimulatedHolonomicBase {
+protected:
+    BodyState state{};
+
+    [[nodiscard]] static core::Error solve3(double m[3][3], double v[3]) noexcept {
+        for(size_t col = 0; col < 3; col++) {
+            size_t pivot = col;
+
+            for(size_t row = col + 1; row < 3; row++) {
+                if(core::absF(m[row][col]) > core::absF(m[pivot][col])) pivot = row;
+            }
+
+            if(core::absF(m[pivot][col]) < 1e-12) {
+                return {core::ErrorCode::invalidConfiguration, "The motor layout cannot determine the platform motion"};
+            }
+
+            if(pivot != col) {
+                for(size_t k = 0; k < 3; k++) {
+                    const double t = m[col][k];
+                    m[col][k] = m[pivot][k];
+                    m[pivot][k] = t;
+                }
+
+                const double t = v[col];
+                v[col] = v[pivot];
+                v[pivot] = t;
+            }
+
+            for(size_t row = 0; row < 3; row++) {
+                if(row == col) continue;
+
+                const double f = m[row][col] / m[col][col];
+                for(size_t k = col; k < 3; k++) m[row][k] -= f * m[col][k];
+                v[row] -= f * v[col];
+            }
+        }
+
+        for(size_t i = 0; i < 3; i++) v[i] /= m[i][i];
+
+        return {};
+    }
+
+public:
+
+    SimulatedHolonomicBase() = default;
+
+    SimulatedHolonomicBase(const BodyState& initial) noexcept : state(initial) {}
+
+    [[nodiscard]] core::Result<BodyState> calculateVelocity(const platform::PlatformMotorConfig& config, const platform::PlatformMotorSpeeds& speeds) const noexcept {
+        if(config.Size() != speeds.Size()) {
+            return core::Error(core::ErrorCode::invalidArgument, "Cannot simulate the platform as motor config and speeds sizes differ");
+        }
+
+        double ata[3][3]{};
+        double atb[3]{};
+
+        for(size_t i = 0; i < config.Size(); i++) {
+            const double parallel = config[i].parallelAxisesAmount != 0 ? static_cast<double>(config[i].parallelAxisesAmount) : 1;
+            const double row[3] = {
+                cos(config[i].anglePos * degreesToRadians) / parallel,
+                sin(config[i].anglePos * degreesToRadians) / parallel,
+                config[i].distance
+            };
+            const double b = speeds[i] * (config[i].wheelR != 0 ? config[i].wheelR : 1);
+
+            for(size_t r = 0; r < 3; r++) {
+                for(size_t c = 0; c < 3; c++) ata[r][c] += row[r] * row[c];
+                atb[r] += row[r] * b;
+            }
+        }
+
+        core::Error err = solve3(ata, atb);
+        if(err) return err;
+
+        BodyState velocity{};
+        velocity.velocityX = atb[0];
+        velocity.velocityY = atb[1];
+        velocity.angularSpeed = atb[2];
+
+        return velocity;
+    }
+
+    [[nodiscard]] core::Error step(const platform::PlatformMotorConfig& config, const platform::PlatformMotorSpeeds& speeds, double dt) noexcept {
+        if(dt <= 0) return {core::ErrorCode::invalidArgument, "Simulation step must be positive"};
+
+        core::Result<BodyState> velocity = calculateVelocity(config, speeds);
+        if(velocity) return velocity.error();
+
+        const double vx = velocity().velocityX;
+        const double vy = velocity().velocityY;
+        const double w = velocity().angularSpeed;
+
+        // body frame acceleration including the centripetal part, this is what an IMU on the base measures,
+        // the body axes turn by -w in their own angle sense
+        state.accelerationX = (vx - state.velocityX) / dt + w * vy;
+        state.accelerationY = (vy - state.velocityY) / dt - w * vx;
+
+        const double midHeading = (state.heading + core::rad2Deg(w) * dt / 2) * degreesToRadians;
+
+        state.x += (vx * cos(midHeading) + vy * sin(midHeading)) * dt;
+        state.y += (vx * sin(midHeading) - vy * cos(midHeading)) * dt;
+        state.heading += core::rad2Deg(w) * dt;
+
+        state.velocityX = vx;
+        state.velocityY = vy;
+        state.angularSpeed = w;
+
+        return {};
+    }
+
+    // steps the motor lags, then integrates the base with the speeds the motors actually reached
+    template <typename Controller_t> [[nodiscard]] core::Error step(core::Array<Controller_t>& controllers, double dt) noexcept {
+        platform::PlatformMotorConfig config(controllers.Size());
+        platform::PlatformMotorSpeeds speeds(controllers.Size());
+
+        for(size_t i = 0; i < controllers.Size(); i++) {
+            controllers[i].step(dt);
+            config[i] = controllers[i].Info();
+
+            core::Result<motor::Speed> speed = controllers[i].getSpeed();
+            if(speed) return speed.error();
+
+            speeds[i] = speed();
+        }
+
+        return step(config, speeds, dt);
+    }
+
+    template <typename Controller_t> [[nodiscard]] core::Error step(platform::Platform<Controller_t>& platform, double dt) noexcept {
+        return step(platform.controllers(), dt);
+    }
+
+    inline const BodyState& getState() const noexcept {
+        return state;
+    }
+
+    inline void setState(const BodyState& state) noexcept {
+        this->state = state;
+    }
+};
+
+struct SimulatedGyroConfig {
+    double yawBias = 0;
+    double yawNoise = 0;
+    double angularSpeedNoise = 0;
+    double accelerationNoise = 0;
+    double gravity = 1;
+    uint32_t seed = 0x9E3779B9u;
+};
+
+// Gyro mounted on a simulated base. step() takes a new sample: the yaw drifts with the configured rate bias
+// and every reading gets uniform noise from a xorshift generator, so runs are reproducible for a given seed.
+// Angular speeds are in degrees per time unit with yaw on axis 0, gravity lies on the z axis.
+class SimulatedGyro : public gyro::YawGetter<core::Angle<>>, public gyro::AngularSpeedGetter<double>, public gyro::AccelerationGetter<double> {
+protected:
+    const SimulatedHolonomicBase* base = nullptr;
+    SimulatedGyroConfig config{};
+    uint32_t randomState = 0;
+
+    double drift = 0;
+    double yaw = 0;
+    double speed[3]{};
+    double acceleration[3]{};
+
+    inline double noise(double amplitude) noexcept {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+
+        return amplitude * (static_cast<double>(randomState) / 2147483647.5 - 1);
+    }
+
+public:
+
+    SimulatedGyro() = default;
+
+    SimulatedGyro(const SimulatedHolonomicBase* base, const SimulatedGyroConfig& config = {}) noexcept
+    : base(base), config(config), randomState(config.seed != 0 ? config.seed : 1) {
+        step(0);
+    }
+
+    void step(double dt) noexcept {
+        if(base == nullptr) return;
+
+        const BodyState& state = base->getState();
+
+        drift += config.yawBias * dt;
+
+        yaw = state.heading + drift + noise(config.yawNoise);
+        speed[0] = core::rad2Deg(state.angularSpeed) + config.yawBias + noise(config.angularSpeedNoise);
+        speed[1] = noise(config.angularSpeedNoise);
+        speed[2] = noise(config.angularSpeedNoise);
+        acceleration[0] = state.accelerationX + noise(config.accelerationNoise);
+        acceleration[1] = state.accelerationY + noise(config.accelerationNoise);
+        acceleration[2] = config.gravity + noise(config.accelerationNoise);
+    }
+
+    core::Result<core::Angle<>> getYaw() const noexcept override {
+        if(base == nullptr) return core::Error(core::ErrorCode::invalidResource, "The simulated gyro isn't attached to a base");
+
+        return core::Angle<>(yaw);
+    }
+
+    core::Result<gyro::AngularSpeed<double>> getAngularSpeed() const noexcept override {
+        if(base == nullptr) return core::Error(core::ErrorCode::invalidResource, "The simulated gyro isn't attached to a base");
+
+        gyro::AngularSpeed<double> result(3);
+        for(size_t i = 0; i < 3; i++) result[i] = speed[i];
+
+        return result;
+    }
+
+    core::Result<gyro::Acceleration<double>> getAcceleration() const noexcept override {
+        if(base == nullptr) return core::Error(core::ErrorCode::invalidResource, "The simulated gyro isn't attached to a base");
+
+        gyro::Acceleration<double> result(3);
+        for(size_t i = 0; i < 3; i++) result[i] = acceleration[i];
+
+        return result;
+    }
+
+    inline double getDrift() const noexcept {
+        return drift;
+    }
+
+    ~SimulatedGyro() override = default;
+};
+
+template <typename Time_t> class SimulationClock {
+protected:
+    Time_t now{};
+
+public:
+
+    SimulationClock() = default;
+
+    SimulationClock(const Time_t& start) noexcept : now(start) {}
+
+    inline void advance(const Time_t& dt) noexcept {
+        now += dt;
+    }
+
+    inline Time_t operator()() const noexcept {
+        return now;
+    }
+};
+
+// copyable view of a SimulationClock, usable as Clock_t of StaticGyroPlatform while the simulation advances the clock
+template <typename Time_t> class SimulationClockHandle {
+protected:
+    const SimulationClock<Time_t>* clock = nullptr;
+
+public:
+
+    SimulationClockHandle() = default;
+
+    SimulationClockHandle(const SimulationClock<Time_t>* clock) noexcept : clock(clock) {}
+
+    inline Time_t operator()() const noexcept {
+        return clock != nullptr ? (*clock)() : Time_t{};
+    }
+};
+
+} // namespace vislib::simulation
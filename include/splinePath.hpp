@@ -0,0 +1,295 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <math.h>
+
+#include "gyro.hpp"
+#include "pathFollower.hpp"
+
+namespace vislib::platform {
+
+struct PathVector {
+    double x = 0;
+    double y = 0;
+};
+
+// cubic Bezier segment, the platform heading goes linearly from startHeading to endHeading over the parameter
+struct BezierSegment {
+    PathVector p0{};
+    PathVector p1{};
+    PathVector p2{};
+    PathVector p3{};
+    double startHeading = 0;
+    double endHeading = 0;
+
+    inline PathVector position(double t) const noexcept {
+        const double u = 1 - t;
+        const double a = u * u * u;
+        const double b = 3 * u * u * t;
+        const double c = 3 * u * t * t;
+        const double d = t * t * t;
+
+        return {a * p0.x + b * p1.x + c * p2.x + d * p3.x, a * p0.y + b * p1.y + c * p2.y + d * p3.y};
+    }
+
+    inline PathVector derivative(double t) const noexcept {
+        const double u = 1 - t;
+        const double a = 3 * u * u;
+        const double b = 6 * u * t;
+        const double c = 3 * t * t;
+
+        return {
+            a * (p1.x - p0.x) + b * (p2.x - p1.x) + c * (p3.x - p2.x),
+            a * (p1.y - p0.y) + b * (p2.y - p1.y) + c * (p3.y - p2.y)
+        };
+    }
+
+    inline PathVector secondDerivative(double t) const noexcept {
+        const double u = 1 - t;
+
+        return {
+            6 * u * (p2.x - 2 * p1.x + p0.x) + 6 * t * (p3.x - 2 * p2.x + p1.x),
+            6 * u * (p2.y - 2 * p1.y + p0.y) + 6 * t * (p3.y - 2 * p2.y + p1.y)
+        };
+    }
+
+    // signed, positive when the path turns counterclockwise
+    inline double curvature(double t) const noexcept {
+        const PathVector d = derivative(t);
+        const PathVector dd = secondDerivative(t);
+        const double speed = hypot(d.x, d.y);
+
+        return speed > 0 ? (d.x * dd.y - d.y * dd.x) / (speed * speed * speed) : 0;
+    }
+
+    // 5 point Gauss-Legendre quadrature of the speed over [t0, t1]
+    double length(double t0, double t1) const noexcept {
+        static constexpr double nodes[5] = {0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+        static constexpr double weights[5] = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891};
+
+        const double half = (t1 - t0) / 2;
+        const double middle = (t0 + t1) / 2;
+        double sum = 0;
+
+        for(size_t i = 0; i < 5; i++) {
+            const PathVector d = derivative(middle + half * nodes[i]);
+            sum += weights[i] * hypot(d.x, d.y);
+        }
+
+        return sum * half;
+    }
+};
+
+struct SplineSample {
+    double x = 0;
+    double y = 0;
+    double tangent = 0;
+    double curvature = 0;
+    double heading = 0;
+};
+
+// Chain of Bezier segments with an arc length table built once by adaptive subdivision: an interval is split
+// until the quadrature of its halves agrees with the whole and interpolating the parameter linearly over the
+// interval misses its middle by less than the tolerance, in distance units. Lookups by distance binary search
+// the table, monotone queries as from a follower or a motion profile resume from the previous entry in O(1).
+template <size_t MaxSegments, size_t MaxSamples = MaxSegments * 64> class SplinePath {
+protected:
+    struct TableEntry {
+        double distance = 0;
+        size_t segment = 0;
+        double t = 0;
+    };
+
+    BezierSegment segments[MaxSegments]{};
+    size_t segmentCount = 0;
+
+    TableEntry table[MaxSamples]{};
+    size_t sampleCount = 0;
+    size_t cursor = 0;
+    bool isBuilt = false;
+
+    [[nodiscard]] core::Error subdivide(size_t segment, double t0, double t1, double length, double& distance, double tolerance, size_t depth) noexcept {
+        const double middle = (t0 + t1) / 2;
+        const double first = segments[segment].length(t0, middle);
+        const double second = segments[segment].length(middle, t1);
+
+        const double total = first + second;
+        const double linearMiddle = total > 0 ? t0 + (t1 - t0) * first / total : middle;
+        const PathVector d = segments[segment].derivative(middle);
+        const double interpolationError = core::absF(linearMiddle - middle) * hypot(d.x, d.y);
+
+        if(depth < 12 && (depth < 2 || core::absF(total - length) > tolerance || interpolationError > tolerance)) {
+            core::Error err = subdivide(segment, t0, middle, first, distance, tolerance, depth + 1);
+            if(err) return err;
+
+            return subdivide(segment, middle, t1, second, distance, tolerance, depth + 1);
+        }
+
+        if(sampleCount + 2 > MaxSamples) return {core::ErrorCode::outOfRange, "The spline arc length table is full"};
+
+        distance += first;
+        table[sampleCount++] = {distance, segment, middle};
+        distance += second;
+        table[sampleCount++] = {distance, segment, t1};
+
+        return {};
+    }
+
+    inline size_t locate(double distance) noexcept {
+        // fast path for queries moving forward or staying within the same entry
+        if(cursor + 1 < sampleCount && !(distance < table[cursor].distance)) {
+            if(distance <= table[cursor + 1].distance) return cursor;
+            if(cursor + 2 < sampleCount && distance <= table[cursor + 2].distance) return ++cursor;
+        }
+
+        size_t low = 0;
+        size_t high = sampleCount - 1;
+
+        while(high - low > 1) {
+            const size_t middle = (low + high) / 2;
+
+            if(table[middle].distance < distance) low = middle;
+            else high = middle;
+        }
+
+        cursor = low;
+
+        return cursor;
+    }
+
+public:
+
+    SplinePath() = default;
+
+    [[nodiscard]] core::Error addSegment(const BezierSegment& segment) noexcept {
+        if(segmentCount >= MaxSegments) return {core::ErrorCode::outOfRange, "The spline path has no free segment slots"};
+
+        segments[segmentCount++] = segment;
+        isBuilt = false;
+
+        return {};
+    }
+
+    // Catmull-Rom spline through the points, converted to Bezier segments, headings are taken from the points
+    [[nodiscard]] core::Error setWaypoints(const core::Array<PathPoint>& points) noexcept {
+        if(points.Size() < 2) return {core::ErrorCode::invalidArgument, "A spline path needs at least two waypoints"};
+
+        clear();
+
+        // headings are unwrapped along the path, so the sampled heading is continuous across waypoints
+        double heading = points[0].heading;
+
+        for(size_t i = 0; i + 1 < points.Size(); i++) {
+            const PathPoint& a = points[i];
+            const PathPoint& b = points[i + 1];
+            const PathPoint& before = points[i > 0 ? i - 1 : i];
+            const PathPoint& after = points[i + 2 < points.Size() ? i + 2 : i + 1];
+
+            BezierSegment segment;
+            segment.p0 = {a.x, a.y};
+            segment.p1 = {a.x + (b.x - before.x) / 6, a.y + (b.y - before.y) / 6};
+            segment.p2 = {b.x - (after.x - a.x) / 6, b.y - (after.y - a.y) / 6};
+            segment.p3 = {b.x, b.y};
+            segment.startHeading = heading;
+            heading += gyro::shortestAngleDifference(a.heading, b.heading);
+            segment.endHeading = heading;
+
+            core::Error err = addSegment(segment);
+            if(err) return err;
+        }
+
+        return build();
+    }
+
+    [[nodiscard]] core::Error build(double tolerance = 1e-3) noexcept {
+        isBuilt = false;
+        sampleCount = 0;
+        cursor = 0;
+
+        if(segmentCount == 0) return {core::ErrorCode::invalidConfiguration, "The spline path has no segments"};
+
+        table[sampleCount++] = {0, 0, 0};
+        double distance = 0;
+
+        for(size_t i = 0; i < segmentCount; i++) {
+            core::Error err = subdivide(i, 0, 1, segments[i].length(0, 1), distance, tolerance, 0);
+            if(err) return err;
+        }
+
+        isBuilt = true;
+
+        return {};
+    }
+
+    void clear() noexcept {
+        segmentCount = 0;
+        sampleCount = 0;
+        cursor = 0;
+        isBuilt = false;
+    }
+
+    inline double length() const noexcept {
+        return sampleCount > 0 ? table[sampleCount - 1].distance : 0;
+    }
+
+    [[nodiscard]] core::Result<SplineSample> sample(double distance) noexcept {
+        if(!isBuilt) return core::Error(core::ErrorCode::invalidConfiguration, "The spline arc length table isn't built");
+
+        if(distance < 0) distance = 0;
+        if(distance > length()) distance = length();
+
+        const size_t index = locate(distance);
+        const TableEntry& a = table[index];
+        const TableEntry& b = table[index + 1 < sampleCount ? index + 1 : index];
+
+        // entries of neighbouring segments meet at t = 1 / t = 0
+        const double startT = a.segment == b.segment ? a.t : 0;
+        const double span = b.distance - a.distance;
+        const double k = span > 0 ? (distance - a.distance) / span : 0;
+        const double t = startT + (b.t - startT) * k;
+
+        const BezierSegment& segment = segments[b.segment];
+        const PathVector point = segment.position(t);
+        const PathVector d = segment.derivative(t);
+
+        SplineSample result;
+        result.x = point.x;
+        result.y = point.y;
+        result.tangent = core::rad2Deg(atan2(d.y, d.x));
+        result.curvature = segment.curvature(t);
+        result.heading = segment.startHeading + (segment.endHeading - segment.startHeading) * t;
+
+        return result;
+    }
+
+    // evenly spaced points for PurePursuitFollower::setPath
+    [[nodiscard]] core::Result<core::Array<PathPoint>> toPolyline(double spacing) noexcept {
+        if(!isBuilt) return core::Error(core::ErrorCode::invalidConfiguration, "The spline arc length table isn't built");
+
+        if(!(spacing > 0)) return core::Error(core::ErrorCode::invalidArgument, "Polyline spacing must be positive");
+
+        const size_t count = static_cast<size_t>(ceil(length() / spacing)) + 1;
+        core::Array<PathPoint> points(count);
+
+        for(size_t i = 0; i < count; i++) {
+            core::Result<SplineSample> s = sample(i + 1 < count ? i * spacing : length());
+            if(s) return s.error();
+
+            points[i].x = s().x;
+            points[i].y = s().y;
+            points[i].heading = s().heading;
+        }
+
+        return points;
+    }
+
+    inline size_t getSegmentCount() const noexcept {
+        return segmentCount;
+    }
+
+    inline size_t getSampleCount() const noexcept {
+        return sampleCount;
+    }
+};
+
+} // namespace vislib::platform
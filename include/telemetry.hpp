@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <stdint.h>
+
+namespace vislib::telemetry {
+
+// one control loop tick, fixed layout so records can be copied and encoded without touching the heap
+template <typename Time_t, size_t Motors> struct ControlRecord {
+    Time_t time{};
+    float yaw{};
+    float head{};
+    float pidError{};
+    float pidIntegral{};
+    float pidDerivative{};
+    float pidOutput{};
+    float speeds[Motors]{};
+    uint16_t errcode = 0;
+};
+
+// Single producer single consumer ring buffer. The control loop pushes, a lower priority task drains.
+// Indices only ever grow and are published with acquire/release atomics, so neither side ever blocks.
+// A full buffer drops the newest record instead of stalling the producer.
+template <typename Record_t, size_t Capacity> class RingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Ring buffer capacity must be a power of two");
+
+protected:
+    Record_t records[Capacity]{};
+    size_t head = 0;
+    size_t tail = 0;
+    size_t dropped = 0;
+
+public:
+
+    bool push(const Record_t& record) noexcept {
+        const size_t h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        const size_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+
+        if(h - t >= Capacity) {
+            __atomic_store_n(&dropped, __atomic_load_n(&dropped, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+            return false;
+        }
+
+        records[h & (Capacity - 1)] = record;
+        __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+
+        return true;
+    }
+
+    // the returned record stays valid and untouched by the producer until release() is called
+    const Record_t* peek() const noexcept {
+        const size_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+        const size_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+
+        if(t == h) return nullptr;
+
+        return &records[t & (Capacity - 1)];
+    }
+
+    void release() noexcept {
+        const size_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+
+        if(t == __atomic_load_n(&head, __ATOMIC_ACQUIRE)) return;
+
+        __atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+    }
+
+    bool pop(Record_t& record) noexcept {
+        const Record_t* front = peek();
+        if(front == nullptr) return false;
+
+        record = *front;
+        release();
+
+        return true;
+    }
+
+    // tail is loaded first so head can't be older than it, the producer may still push past the loaded tail
+    // in between, hence the clamp
+    size_t size() const noexcept {
+        const size_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+        const size_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+        const size_t count = h - t;
+
+        return count < Capacity ? count : Capacity;
+    }
+
+    inline constexpr size_t capacity() const noexcept {
+        return Capacity;
+    }
+
+    size_t getDropped() const noexcept {
+        return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+    }
+};
+
+template <typename Time_t, size_t Motors, size_t Capacity> using ControlRecorder = RingBuffer<ControlRecord<Time_t, Motors>, Capacity>;
+
+} // namespace vislib::telemetry
@@ -0,0 +1,412 @@
+#pragma once
+
+#include <vislib.hpp>
+#include <stdint.h>
+#include <string.h>
+
+#include "checksum.hpp"
+#include "gyro.hpp"
+#include "trapezoidalMotion.hpp"
+#include "telemetry.hpp"
+
+namespace vislib::telemetry {
+
+// Frame: COBS(header | body | crc16) 0x00
+// header: format version (u8) | record type (u8) | sequence (u16), all multi-byte values are little endian
+// Bodies are described by the schema tables below so a host tool can decode them without this header.
+
+constexpr uint8_t formatVersion = 1;
+constexpr size_t frameHeaderSize = 4;
+
+enum class RecordType : uint8_t {
+    control = 1,
+    gyroData = 2,
+    motionProfile = 3
+};
+
+enum class FieldType : uint8_t {
+    u8 = 1,
+    u16,
+    u32,
+    f32,
+    f64
+};
+
+// count 0 means the repeat count is stored in the preceding u8 field
+struct FieldDescriptor {
+    const char* name;
+    FieldType type;
+    uint8_t count;
+};
+
+template <typename Time_t> constexpr bool isFloatingTime = Time_t(1) / Time_t(2) != Time_t(0);
+
+template <typename Time_t> constexpr FieldType timeFieldType = isFloatingTime<Time_t> ? FieldType::f64 : FieldType::u32;
+
+template <typename Time_t> constexpr FieldDescriptor controlSchema[] = {
+    {"time", timeFieldType<Time_t>, 1},
+    {"yaw", FieldType::f32, 1},
+    {"head", FieldType::f32, 1},
+    {"pidError", FieldType::f32, 1},
+    {"pidIntegral", FieldType::f32, 1},
+    {"pidDerivative", FieldType::f32, 1},
+    {"pidOutput", FieldType::f32, 1},
+    {"motors", FieldType::u8, 1},
+    {"speeds", FieldType::f32, 0},
+    {"errcode", FieldType::u16, 1}
+};
+
+template <typename Time_t> constexpr FieldDescriptor gyroDataSchema[] = {
+    {"time", timeFieldType<Time_t>, 1},
+    {"ypr", FieldType::f32, 3},
+    {"acceleration", FieldType::f32, 3},
+    {"speed", FieldType::f32, 3}
+};
+
+template <typename Time_t> constexpr FieldDescriptor motionProfileSchema[] = {
+    {"time", timeFieldType<Time_t>, 1},
+    {"position", FieldType::f32, 1},
+    {"speed", FieldType::f32, 1},
+    {"acceleration", FieldType::f32, 1}
+};
+
+// unsigned integer of the same size as a serialized value, its bits are written byte by byte
+template <size_t Size> struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> { using type = uint8_t; };
+template <> struct UnsignedOfSize<2> { using type = uint16_t; };
+template <> struct UnsignedOfSize<4> { using type = uint32_t; };
+template <> struct UnsignedOfSize<8> { using type = uint64_t; };
+
+// writes COBS encoded bytes straight into the output buffer, so records never need an intermediate copy
+class CobsWriter {
+protected:
+    uint8_t* out = nullptr;
+    size_t capacity = 0;
+    size_t pos = 0;
+    size_t codePos = 0;
+    uint8_t code = 1;
+    uint16_t crc = 0xFFFF;
+    bool isOverflowed = false;
+
+    inline void emit(uint8_t byte) noexcept {
+        if(byte == 0) {
+            closeBlock();
+            return;
+        }
+
+        if(pos >= capacity) {
+            isOverflowed = true;
+            return;
+        }
+
+        out[pos++] = byte;
+
+        if(++code == 0xFF) closeBlock();
+    }
+
+    inline void closeBlock() noexcept {
+        if(codePos >= capacity || pos >= capacity) {
+            isOverflowed = true;
+            return;
+        }
+
+        out[codePos] = code;
+        codePos = pos++;
+        code = 1;
+    }
+
+public:
+
+    CobsWriter(uint8_t* out, size_t capacity) noexcept : out(out), capacity(capacity), pos(1) {}
+
+    inline void write(const void* data, size_t size) noexcept {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        crc = crc16(bytes, size, crc);
+
+        for(size_t i = 0; i < size; i++) emit(bytes[i]);
+    }
+
+    // little endian whatever the byte order of the target is
+    template <typename V> inline void put(const V& value) noexcept {
+        typename UnsignedOfSize<sizeof(V)>::type bits;
+        memcpy(&bits, &value, sizeof(V));
+
+        uint8_t bytes[sizeof(V)];
+        for(size_t i = 0; i < sizeof(V); i++) bytes[i] = static_cast<uint8_t>(bits >> (8 * i));
+
+        write(bytes, sizeof(V));
+    }
+
+    [[nodiscard]] core::Result<size_t> finish() noexcept {
+        const uint16_t sum = crc;
+        const uint8_t tail[2] = {static_cast<uint8_t>(sum & 0xFF), static_cast<uint8_t>(sum >> 8)};
+
+        emit(tail[0]);
+        emit(tail[1]);
+
+        if(isOverflowed || codePos >= capacity || pos >= capacity) {
+            return core::Error(core::ErrorCode::outOfRange, "The telemetry frame doesn't fit into the output buffer");
+        }
+
+        out[codePos] = code;
+        out[pos++] = 0;
+
+        return pos;
+    }
+};
+
+template <typename Time_t> inline void putTime(CobsWriter& writer, const Time_t& time) noexcept {
+    if constexpr (isFloatingTime<Time_t>) writer.put(static_cast<double>(time));
+    else writer.put(static_cast<uint32_t>(time));
+}
+
+class FrameEncoder {
+protected:
+    uint16_t sequence = 0;
+
+    void putHeader(CobsWriter& writer, RecordType type) noexcept {
+        writer.put(formatVersion);
+        writer.put(static_cast<uint8_t>(type));
+        writer.put(sequence++);
+    }
+
+public:
+
+    template <typename Time_t, size_t Motors> [[nodiscard]] core::Result<size_t> encode(const ControlRecord<Time_t, Motors>& record, uint8_t* out, size_t capacity) noexcept {
+        static_assert(Motors < 256, "Telemetry format supports up to 255 motors");
+
+        CobsWriter writer(out, capacity);
+
+        putHeader(writer, RecordType::control);
+        putTime(writer, record.time);
+        writer.put(record.yaw);
+        writer.put(record.head);
+        writer.put(record.pidError);
+        writer.put(record.pidIntegral);
+        writer.put(record.pidDerivative);
+        writer.put(record.pidOutput);
+        writer.put(static_cast<uint8_t>(Motors));
+        for(size_t i = 0; i < Motors; i++) writer.put(record.speeds[i]);
+        writer.put(record.errcode);
+
+        return writer.finish();
+    }
+
+    template <typename Time_t, typename YPRType, typename AccAngularSpeedType> [[nodiscard]] core::Result<size_t> encode(
+        const Time_t& time, const gyro::GyroData<YPRType, AccAngularSpeedType>& data, uint8_t* out, size_t capacity) noexcept {
+
+        if(data.acceleration.Size() < 3 || data.speed.Size() < 3) return core::Error(core::ErrorCode::invalidArgument, "Gyro data telemetry requires three axis vectors");
+
+        CobsWriter writer(out, capacity);
+
+        putHeader(writer, RecordType::gyroData);
+        putTime(writer, time);
+        writer.put(static_cast<float>(data.ypr.yaw));
+        writer.put(static_cast<float>(data.ypr.pitch));
+        writer.put(static_cast<float>(data.ypr.roll));
+
+        for(size_t i = 0; i < 3; i++) writer.put(static_cast<float>(data.acceleration[i]));
+        for(size_t i = 0; i < 3; i++) writer.put(static_cast<float>(data.speed[i]));
+
+        return writer.finish();
+    }
+
+    template <typename Time_t, typename T> [[nodiscard]] core::Result<size_t> encode(const Time_t& time, const TMPResult<T>& result, uint8_t* out, size_t capacity) noexcept {
+        CobsWriter writer(out, capacity);
+
+        putHeader(writer, RecordType::motionProfile);
+        putTime(writer, time);
+        writer.put(static_cast<float>(result.position));
+        writer.put(static_cast<float>(result.speed));
+        writer.put(static_cast<float>(result.acceleration));
+
+        return writer.finish();
+    }
+
+    // encodes the oldest record in place and releases it only if the frame fit into the buffer
+    template <typename Time_t, size_t Motors, size_t Capacity> [[nodiscard]] core::Result<size_t> encodeNext(
+        RingBuffer<ControlRecord<Time_t, Motors>, Capacity>& buffer, uint8_t* out, size_t capacity) noexcept {
+
+        const ControlRecord<Time_t, Motors>* record = buffer.peek();
+        if(record == nullptr) return size_t(0);
+
+        core::Result<size_t> size = encode(*record, out, capacity);
+        if(size) return size;
+
+        buffer.release();
+
+        return size;
+    }
+};
+
+// decoding side, used by host tools reading the stream
+
+[[nodiscard]] inline core::Result<size_t> cobsDecode(const uint8_t* in, size_t size, uint8_t* out, size_t capacity) noexcept {
+    size_t read = 0;
+    size_t written = 0;
+
+    while(read < size) {
+        const uint8_t code = in[read++];
+
+        if(code == 0) return core::Error(core::ErrorCode::invalidResource, "Unexpected zero byte inside a COBS frame");
+
+        for(uint8_t i = 1; i < code; i++) {
+            if(read >= size) return core::Error(core::ErrorCode::invalidResource, "Truncated COBS block");
+            if(written >= capacity) return core::Error(core::ErrorCode::outOfRange, "Decoded COBS frame doesn't fit into the output buffer");
+
+            out[written++] = in[read++];
+        }
+
+        if(code != 0xFF && read < size) {
+            if(written >= capacity) return core::Error(core::ErrorCode::outOfRange, "Decoded COBS frame doesn't fit into the output buffer");
+
+            out[written++] = 0;
+        }
+    }
+
+    return written;
+}
+
+struct FrameView {
+    uint8_t version = 0;
+    RecordType type = RecordType::control;
+    uint16_t sequence = 0;
+    const uint8_t* body = nullptr;
+    size_t bodySize = 0;
+};
+
+// decodes a frame without its 0x00 delimiter into the scratch buffer and checks the CRC and version
+[[nodiscard]] inline core::Result<FrameView> decodeFrame(const uint8_t* frame, size_t size, uint8_t* scratch, size_t capacity) noexcept {
+    core::Result<size_t> decoded = cobsDecode(frame, size, scratch, capacity);
+    if(decoded) return decoded.error();
+
+    if(decoded() < frameHeaderSize + 2) return core::Error(core::ErrorCode::invalidResource, "Telemetry frame is too short");
+
+    const size_t payload = decoded() - 2;
+
+    if(crc16(scratch, payload) != static_cast<uint16_t>(scratch[payload] | (scratch[payload + 1] << 8))) {
+        return core::Error(core::ErrorCode::invalidResource, "Telemetry frame checksum mismatch");
+    }
+
+    if(scratch[0] != formatVersion) return core::Error(core::ErrorCode::invalidResource, "Unsupported telemetry format version");
+
+    FrameView view;
+    view.version = scratch[0];
+    view.type = static_cast<RecordType>(scratch[1]);
+    view.sequence = static_cast<uint16_t>(scratch[2] | (scratch[3] << 8));
+    view.body = scratch + frameHeaderSize;
+    view.bodySize = payload - frameHeaderSize;
+
+    return view;
+}
+
+class FieldReader {
+protected:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+
+public:
+
+    FieldReader(const uint8_t* data, size_t size) noexcept : data(data), size(size) {}
+
+    template <typename V> [[nodiscard]] bool get(V& value) noexcept {
+        if(size - pos < sizeof(V)) return false;
+
+        typename UnsignedOfSize<sizeof(V)>::type bits = 0;
+        for(size_t i = 0; i < sizeof(V); i++) bits |= static_cast<decltype(bits)>(static_cast<decltype(bits)>(data[pos + i]) << (8 * i));
+
+        memcpy(&value, &bits, sizeof(V));
+        pos += sizeof(V);
+
+        return true;
+    }
+
+    template <typename Time_t> [[nodiscard]] bool getTime(Time_t& time) noexcept {
+        if constexpr (isFloatingTime<Time_t>) {
+            double value = 0;
+            if(!get(value)) return false;
+            time = static_cast<Time_t>(value);
+        } else {
+            uint32_t value = 0;
+            if(!get(value)) return false;
+            time = static_cast<Time_t>(value);
+        }
+
+        return true;
+    }
+
+    inline constexpr bool isFinished() const noexcept {
+        return pos == size;
+    }
+};
+
+template <typename Time_t, size_t Motors> [[nodiscard]] core::Error decodeRecord(const FrameView& frame, ControlRecord<Time_t, Motors>& record) noexcept {
+    if(frame.type != RecordType::control) return {core::ErrorCode::invalidArgument, "The telemetry frame doesn't contain a control record"};
+
+    FieldReader reader(frame.body, frame.bodySize);
+    uint8_t motors = 0;
+
+    bool isValid = reader.getTime(record.time) && reader.get(record.yaw) && reader.get(record.head)
+        && reader.get(record.pidError) && reader.get(record.pidIntegral) && reader.get(record.pidDerivative)
+        && reader.get(record.pidOutput) && reader.get(motors);
+
+    if(!isValid || motors != Motors) return {core::ErrorCode::invalidResource, "The control record layout doesn't match the expected one"};
+
+    for(size_t i = 0; i < Motors; i++) isValid = isValid && reader.get(record.speeds[i]);
+
+    if(!isValid || !reader.get(record.errcode) || !reader.isFinished()) return {core::ErrorCode::invalidResource, "The control record is truncated"};
+
+    return {};
+}
+
+// values are read back as the f32 they were sent as, vectors are resized to three axes
+template <typename Time_t, typename YPRType, typename AccAngularSpeedType> [[nodiscard]] core::Error decodeRecord(
+    const FrameView& frame, Time_t& time, gyro::GyroData<YPRType, AccAngularSpeedType>& data) noexcept {
+
+    if(frame.type != RecordType::gyroData) return {core::ErrorCode::invalidArgument, "The telemetry frame doesn't contain a gyro data record"};
+
+    FieldReader reader(frame.body, frame.bodySize);
+    float values[9]{};
+
+    bool isValid = reader.getTime(time);
+    for(size_t i = 0; i < 9; i++) isValid = isValid && reader.get(values[i]);
+
+    if(!isValid || !reader.isFinished()) return {core::ErrorCode::invalidResource, "The gyro data record layout doesn't match the expected one"};
+
+    data.ypr.yaw = static_cast<YPRType>(values[0]);
+    data.ypr.pitch = static_cast<YPRType>(values[1]);
+    data.ypr.roll = static_cast<YPRType>(values[2]);
+
+    if(data.acceleration.Size() < 3) data.acceleration = gyro::Acceleration<AccAngularSpeedType>(3);
+    if(data.speed.Size() < 3) data.speed = gyro::AngularSpeed<AccAngularSpeedType>(3);
+
+    for(size_t i = 0; i < 3; i++) {
+        data.acceleration[i] = static_cast<AccAngularSpeedType>(values[3 + i]);
+        data.speed[i] = static_cast<AccAngularSpeedType>(values[6 + i]);
+    }
+
+    return {};
+}
+
+template <typename Time_t, typename T> [[nodiscard]] core::Error decodeRecord(const FrameView& frame, Time_t& time, TMPResult<T>& result) noexcept {
+    if(frame.type != RecordType::motionProfile) return {core::ErrorCode::invalidArgument, "The telemetry frame doesn't contain a motion profile record"};
+
+    FieldReader reader(frame.body, frame.bodySize);
+    float position = 0;
+    float speed = 0;
+    float acceleration = 0;
+
+    if(!reader.getTime(time) || !reader.get(position) || !reader.get(speed) || !reader.get(acceleration) || !reader.isFinished()) {
+        return {core::ErrorCode::invalidResource, "The motion profile record layout doesn't match the expected one"};
+    }
+
+    result.position = static_cast<T>(position);
+    result.speed = static_cast<T>(speed);
+    result.acceleration = static_cast<T>(acceleration);
+
+    return {};
+}
+
+} // namespace vislib::telemetry
@@ -15,6 +15,9 @@ protected:
     T acceleration{};
     T speedLimit{};
     
+    // signed cruise speed of the current motion, speedLimit itself stays as configured
+    T peakSpeed{};
+    
     T t1{};
     T t2{};
     T t3{};
@@ -47,19 +50,16 @@ public:
         return speedLimit;
     }
     
-    [[nodiscard]] core::Error validCheck() noexcept(core::numberNoexcept<T>()) {
+    [[nodiscard]] core::Error validCheck() const noexcept(core::numberNoexcept<T>()) {
         if(x0 == xt) {
-            endMotion();
             return {core::ErrorCode::reachedTheTarget, "The motion starting position is the same as final destination"};
         }
         
         if(acceleration <= 0) {
-            endMotion();
             return {core::ErrorCode::invalidConfiguration, "The motion controller doesn't support acceleration equal or below zero and is supposed to work with positive values"};
         }
         
         if(speedLimit <= 0) {
-            endMotion();
             return {core::ErrorCode::invalidConfiguration, "The motion controller doesn't support speed limit equal or below zero and is supposed to work with positive values"};
         }
         
@@ -79,8 +79,28 @@ public:
         return isConfiguredFlag;
     }
     
+    // drops the current motion, the acceleration and speed limit are kept for the next one
     inline void endMotion() noexcept(core::numberNoexcept<T, TimeType>()) {
-        *this = TrapezoidalMotionProfile();
+        *this = TrapezoidalMotionProfile(acceleration, speedLimit);
+    }
+    
+    inline void setLimits(const T& acceleration, const T& speedLimit) noexcept(core::numberNoexcept<T, TimeType>()) {
+        this->acceleration = acceleration;
+        this->speedLimit = speedLimit;
+        endMotion();
+    }
+    
+    // time from the start of the motion to reaching the target
+    inline constexpr T getDuration() const noexcept(core::numberNoexcept<T>()) {
+        return t3;
+    }
+    
+    inline constexpr T getTargetPosition() const noexcept(core::numberNoexcept<T>()) {
+        return xt;
+    }
+    
+    inline constexpr bool isFinished(const TimeType& timePoint) const noexcept(core::numberNoexcept<T, TimeType>()) {
+        return isConfiguredFlag && !(timePoint - startTime < t3);
     }
     
     [[nodiscard]] core::Error startMotion(const T& startPosition, const T& targetPosition, const TimeType& startTime = TimeType{}) noexcept(core::numberNoexcept<T, TimeType>()) {
@@ -96,13 +116,13 @@ public:
         
         s = core::signF(xt - x0);
         
-        speedLimit = s * core::minF(speedLimit, sqrt(core::absF(acceleration * (xt - x0))));
+        peakSpeed = s * core::minF(speedLimit, sqrt(core::absF(acceleration * (xt - x0))));
         
-        t1 = core::absF(speedLimit) / acceleration;
+        t1 = core::absF(peakSpeed) / acceleration;
         x1 = x0 + s * acceleration * t1 * t1 / 2.0;
         
-        t2 = t1 + (xt + x0 - 2 * x1) / speedLimit;
-        x2 = x1 + acceleration * (t2 - t1);
+        t2 = t1 + (xt + x0 - 2 * x1) / peakSpeed;
+        x2 = x1 + peakSpeed * (t2 - t1);
         
         t3 = t1 + t2;
         
@@ -130,19 +150,23 @@ public:
         
         if(0 <= t && t <= t1) {
             result.position = x0 + s * acceleration * t * t / 2.0;
-            result.speed = acceleration * t;
-            result.acceleration = acceleration;
+            result.speed = s * acceleration * t;
+            result.acceleration = s * acceleration;
             
         } else if(t1 < t && t < t2) {
-            result.position = x1 + speedLimit * (t - t1);
-            result.speed = speedLimit;
+            result.position = x1 + peakSpeed * (t - t1);
+            result.speed = peakSpeed;
             result.acceleration = 0;
             
         } else if(t2 <= t && t <= t3) {
-            result.position = x2 + speedLimit * (t - t2) - s * acceleration * (t - t2) * (t - t2) / 2.0;
-            result.speed = speedLimit - acceleration * (t - t2);
-            result.acceleration = -acceleration;
+            result.position = x2 + peakSpeed * (t - t2) - s * acceleration * (t - t2) * (t - t2) / 2.0;
+            result.speed = peakSpeed - s * acceleration * (t - t2);
+            result.acceleration = -s * acceleration;
             
+        } else {
+            result.position = xt;
+            result.speed = 0;
+            result.acceleration = 0;
         }
         
         return result;
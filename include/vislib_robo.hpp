@@ -8,4 +8,27 @@
 #include "pid.hpp"
 #include "trapezoidalMotion.hpp"
 #include "callback.hpp"
+#include "loopProfiler.hpp"
+#include "telemetry.hpp"
+#include "telemetryCodec.hpp"
 #include "gyroPLatform.hpp"
+#include "checksum.hpp"
+#include "calibration.hpp"
+#include "biasEstimator.hpp"
+#include "headingFilter.hpp"
+#include "imuFusion.hpp"
+#include "imuFilter.hpp"
+#include "scheduler.hpp"
+#include "replay.hpp"
+#include "simulation.hpp"
+#include "fleetSimulation.hpp"
+#include "pidAutotune.hpp"
+#include "relayAutotuner.hpp"
+#include "cascadeRegulator.hpp"
+#include "matrix.hpp"
+#include "lqr.hpp"
+#include "mpc.hpp"
+#include "pathFollower.hpp"
+#include "splinePath.hpp"
+#include "pathProfile.hpp"
+#include "benchmark.hpp"